@@ -0,0 +1,58 @@
+#pragma once
+
+#include "api.h"
+
+// Lady Brown arm estimator
+//  The potentiometer knows where the arm is but is noisy and coarse, and the motor encoders are
+//  smooth and fine but only know how far the motors have turned.  The estimator learns the ratio
+//  between them while the arm moves, then follows the encoders and slowly pulls their offset
+//  toward the median filtered pot, a complementary filter.  Until the ratio is learned, or if the
+//  pot stops making sense, it falls back to whichever sensor still works.  Readings come from the
+//  sensor hub, so the estimate is updated once per tick.  The estimator is below the Lady Brown
+//  job (jobs.hpp), which runs first each tick and so steers by the angle from the tick before.
+namespace arm {
+
+/**
+ * Struct for the estimator's state.
+ */
+typedef struct status_t {
+  double angle;     // degrees on the pot's scale
+  double velocity;  // deg/s
+  double pot;       // degrees, median filtered pot alone
+  double ratio;     // arm degrees per motor degree
+  bool calibrated;  // ratio learned, encoders are being followed
+  bool pot_ok;      // pot agrees with the encoders
+} status_t;
+
+/**
+ * Starts the estimator task.  Call after sensors::initialize().
+ */
+void initialize();
+
+/**
+ * Returns the arm angle in degrees, on the pot's scale so 0 is the pot's 0.
+ */
+double angle_get();
+
+/**
+ * Returns the arm's angular velocity in deg/s.
+ */
+double velocity_get();
+
+/**
+ * Returns the arm angle in the same units as ldb_pct(), percent of the pot's range, but not rounded.
+ * Reads the pot directly before initialize().
+ */
+double pct_get();
+
+/**
+ * Returns the estimator's state.
+ */
+status_t status_get();
+
+/**
+ * Forgets the learned ratio, the next moves relearn it.
+ */
+void recalibrate();
+
+}  // namespace arm
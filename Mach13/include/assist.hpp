@@ -0,0 +1,115 @@
+#pragma once
+
+#include "EZ-Template/util.hpp"
+#include "api.h"
+
+// Driver assist
+//  Arcade drive with the same sticks, curves and threshold as EZ-Template's, but the forward and turn
+//  commands can only change as fast as the wheels can keep traction.  The limits are tighter with a
+//  goal clamped, and shrink further once the IMU sees the robot starting to tip.  It all runs inline
+//  in the opcontrol loop or the driver task (driver.hpp), so it adds no delay beyond the smoothing itself.
+//  curvature() is the other way to drive: the turn stick sets how tightly the robot curves rather
+//  than how fast it spins, so turning feels the same at any speed.  Hold the quick turn button, or
+//  leave the forward stick centered, to spin in place.
+namespace assist {
+
+/**
+ * Struct for acceleration limits, in output (out of 127) per second.
+ */
+typedef struct limits {
+  double forward_accel;  // speeding up forwards
+  double reverse_accel;  // speeding up backwards
+  double decel;          // slowing down in either direction, a full reversal is decel then accel
+  double turn_accel;     // any change in the turn command
+} limits;
+
+/**
+ * Sets the acceleration limits.
+ *
+ * \param free
+ *        limits with nothing clamped
+ * \param clamped
+ *        limits with a mobile goal clamped
+ */
+void limits_set(limits free, limits clamped);
+
+/**
+ * Sets the anti-tip scaling.  Limits are multiplied by a factor that falls from 1 at start_angle
+ * to min_scale at max_angle of pitch or roll.
+ *
+ * \param start_angle
+ *        degrees of tilt before limits start shrinking
+ * \param max_angle
+ *        degrees of tilt where limits reach min_scale
+ * \param min_scale
+ *        smallest factor, 0 to 1
+ */
+void tilt_set(double start_angle, double max_angle, double min_scale);
+
+/**
+ * Struct for curvature drive tuning.  Turn values are out of 1, a full stick.
+ */
+typedef struct curvature_t {
+  double sensitivity;       // how tightly a full turn stick curves, 1 turns one wheel off at full throttle
+  double negative_inertia;  // extra turn added as the turn stick moves, so the robot starts and stops turning sharply
+  double inertia_decay;     // how much of that extra turn wears off each second
+  double quick_stop;        // 0 to 1, how hard the end of a quick turn is braked as driving resumes
+  double quick_turn_below;  // forward stick, out of 1, below which turning spins in place without the button
+  double max_rate;          // deg/s the robot turns at a full turn output, 0 to skip the turn rate feedback
+  double rate_kp;           // turn output, out of 1, per deg/s the robot turns slower or faster than asked
+} curvature_t;
+
+/**
+ * Sets the curvature drive tuning.
+ */
+void curvature_set(curvature_t tuning);
+
+/**
+ * Sets the button that makes curvature drive spin in place while it's held, the "quick_turn" input binding.
+ * Y by default.  It's ignored while the PID tuner is on, which uses Y, and curvature() turns off
+ * EZ-Template's curve buttons so Y doesn't also change the curve.
+ */
+void quick_turn_button_set(pros::controller_digital_e_t button);
+
+/**
+ * Sets the button that turns every limit off while it's held, the "assist_bypass" input binding.
+ */
+void bypass_button_set(pros::controller_digital_e_t button);
+
+/**
+ * Drives with arcade controls through the limits.  Call this in place of chassis.opcontrol_arcade_standard(),
+ * after input::update().
+ *
+ * \param stick_type
+ *        ez::SPLIT or ez::SINGLE
+ * \param fresh
+ *        true to read the sticks from the controller now rather than input's snapshot, for the driver task
+ */
+void arcade(ez::e_type stick_type, bool fresh = false);
+
+/**
+ * Drives with curvature controls through the limits.  The forward stick sets speed and the turn stick
+ * sets how tightly to curve, scaled by speed so a full turn stick never whips the robot around at full
+ * speed.  Call this in place of assist::arcade(), after input::update().
+ *
+ * \param stick_type
+ *        ez::SPLIT or ez::SINGLE
+ * \param fresh
+ *        true to read the sticks from the controller now rather than input's snapshot, for the driver task
+ */
+void curvature(ez::e_type stick_type, bool fresh = false);
+
+/**
+ * Steps the joystick curves up or down from the "curve_left_down", "curve_left_up", "curve_right_down"
+ * and "curve_right_up" input bindings, and saves them with config::save_async().  In place of
+ * EZ-Template's curve buttons, which would read the controller on their own.  Call in the opcontrol
+ * loop, after input::update().
+ */
+void curves_iterate();
+
+/**
+ * Forgets the current commands and takes the IMU's current pitch and roll as level.
+ */
+void reset();
+
+}  // namespace assist
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "api.h"
+
+// Startup stages
+//  initialize() registers each piece of startup work as a stage with the stages it depends on.
+//  Every stage runs in its own task as soon as its dependencies finish, so IMU calibration,
+//  SD reads and screen setup overlap instead of running one after another.
+namespace boot {
+
+/**
+ * Adds a startup stage.  Stages must be added before start().
+ *
+ * \param name
+ *        name used for dependencies and the timeline
+ * \param stage
+ *        function to run
+ * \param depends_on
+ *        names of the stages that have to finish before this one starts
+ */
+void stage_add(std::string name, std::function<void()> stage, std::vector<std::string> depends_on = {});
+
+/**
+ * Starts every stage and returns right away.
+ */
+void start();
+
+/**
+ * Returns true if the stage has finished.
+ *
+ * \param name
+ *        name of the stage
+ */
+bool done(std::string name);
+
+/**
+ * Blocks until every stage in the list has finished.  Returns false if this timed out.
+ *
+ * \param names
+ *        names of the stages to wait for
+ * \param timeout
+ *        maximum time to wait in ms, defaults to forever
+ */
+bool wait(std::vector<std::string> names, uint32_t timeout = TIMEOUT_MAX);
+
+/**
+ * Blocks until every stage has finished.  Returns false if this timed out.
+ *
+ * \param timeout
+ *        maximum time to wait in ms, defaults to forever
+ */
+bool wait_all(uint32_t timeout = TIMEOUT_MAX);
+
+/**
+ * Prints when each stage started and finished, in ms since the program started.
+ */
+void timeline_print();
+
+}  // namespace boot
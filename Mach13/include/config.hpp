@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdint>
+
+#include "api.h"
+
+// Tuned constants stored on the SD card
+//  The file is a small header (magic, version, payload size, CRC-32) followed by one flat struct,
+//  so startup loads everything with a single read.  Saving writes a temporary file first and then
+//  renames it over the old one, so pulling power mid-save never leaves a half written config.
+namespace config {
+
+/**
+ * Struct for PID constants.
+ */
+typedef struct pid_gains {
+  float kp;
+  float ki;
+  float kd;
+  float start_i;
+} pid_gains;
+
+/**
+ * Struct for PID exit conditions.
+ */
+typedef struct exit_gains {
+  int32_t small_exit_time;
+  float small_error;
+  int32_t big_exit_time;
+  float big_error;
+  int32_t velocity_exit_time;
+  int32_t mA_timeout;
+} exit_gains;
+
+/**
+ * Struct for slew constants.
+ */
+typedef struct slew_gains {
+  float distance;
+  int32_t min_speed;
+} slew_gains;
+
+/**
+ * Everything that's stored.  New fields must only ever be added to the end,
+ * older files then load everything they have and keep defaults for the rest.
+ */
+typedef struct values_t {
+  // PID constants
+  pid_gains drive_forward;
+  pid_gains drive_backward;
+  pid_gains heading;
+  pid_gains turn;
+  pid_gains swing_forward;
+  pid_gains swing_backward;
+  pid_gains odom_angular;
+  pid_gains boomerang;
+
+  // Exit conditions
+  exit_gains drive_exit;
+  exit_gains turn_exit;
+  exit_gains swing_exit;
+
+  // Motion chaining
+  float drive_chain_forward;
+  float drive_chain_backward;
+  float turn_chain;
+  float swing_chain_forward;
+  float swing_chain_backward;
+
+  // Slew
+  slew_gains slew_drive_forward;
+  slew_gains slew_drive_backward;
+
+  // Joystick curves
+  float curve_left;
+  float curve_right;
+
+  // Subsystem setpoints
+  int32_t ldb_speed;
+  int32_t ldb_min_angle;
+  int32_t ldb_load_angle;
+  int32_t ldb_max_angle;
+} values_t;
+
+/**
+ * Current version of values_t.  Bump this whenever a field is added.
+ */
+const uint16_t VERSION = 1;
+
+/**
+ * Where the config lives on the SD card.
+ */
+const char* const PATH = "/usd/m13_config.bin";
+
+/**
+ * Values currently in use.
+ */
+extern values_t values;
+
+/**
+ * Copies the current chassis constants and subsystem setpoints into values.
+ */
+void capture();
+
+/**
+ * Applies values to the chassis and subsystems.
+ */
+void apply();
+
+/**
+ * Reads the config from the SD card into values and applies it.
+ *
+ * Returns false and leaves everything untouched if there is no SD card or no valid file.
+ */
+bool load();
+
+/**
+ * Captures the current constants and writes them to the SD card.  Returns true if it saved.
+ */
+bool save();
+
+/**
+ * Runs save() in its own task so a control loop never waits on the SD card.
+ */
+void save_async();
+
+}  // namespace config
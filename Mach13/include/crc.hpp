@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Checksums shared by the robot and the host tools, so this only depends on the standard library
+namespace crc {
+
+/**
+ * Returns the CRC-32 (IEEE 802.3, the one zip uses) of a buffer.
+ *
+ * \param data
+ *        bytes to check
+ * \param length
+ *        number of bytes
+ * \param crc
+ *        running value when checking a buffer in pieces, defaults to a fresh start
+ */
+inline uint32_t crc32(const void* data, size_t length, uint32_t crc = 0) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  crc = ~crc;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= bytes[i];
+    for (int bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+  }
+  return ~crc;
+}
+
+/**
+ * Returns the CRC-16/CCITT-FALSE of a buffer, used for short telemetry frames.
+ *
+ * \param data
+ *        bytes to check
+ * \param length
+ *        number of bytes
+ */
+inline uint16_t crc16(const void* data, size_t length) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= (uint16_t)(bytes[i] << 8);
+    for (int bit = 0; bit < 8; bit++) crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+  }
+  return crc;
+}
+
+}  // namespace crc
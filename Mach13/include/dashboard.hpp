@@ -0,0 +1,136 @@
+#pragma once
+
+#include <functional>
+
+#include "EZ-Template/util.hpp"
+#include "api.h"
+
+// Brain screen dashboard
+//  Live top-down field map (robot pose, planned path, current target) plus motor temperature and current bars.
+//  Everything is drawn with LVGL objects that are only touched when their on-screen value changes,
+//  so LVGL only redraws the small areas that actually moved.
+//  The updates run as an LVGL timer in LVGL's own task, so they never race its redraw, and the other
+//  functions here only hand data over.  Even the timer is created from LVGL's task, on its next
+//  display refresh, and lvgl_run() does the same for other screens.
+namespace dashboard {
+
+/**
+ * Struct for the cost of the dashboard task.
+ */
+typedef struct cpu_stats {
+  uint32_t last_us;   // time spent in the last update, including LVGL's redraw since the one before
+  uint32_t avg_us;    // smoothed time spent per update
+  uint32_t redraw_us; // smoothed part of that spent in LVGL's redraw, in whole milliseconds
+  uint32_t peak_us;   // worst update since initialize()
+  uint32_t period_ms; // current update period
+  double load_pct;    // avg_us as a percent of the period
+} cpu_stats;
+
+/**
+ * Starts the LVGL timer that builds the dashboard screen and updates it, from LVGL's task on its
+ * next display refresh.
+ *
+ * The screen isn't shown until show() is called, so the auton selector keeps the brain until then.
+ */
+void initialize();
+
+/**
+ * Runs a function every period as an LVGL timer, in LVGL's own task, for screens other than the
+ * dashboard.  The timer is created from LVGL's task on its next display refresh, so this can be
+ * called from any task.
+ *
+ * \param period_ms
+ *        how often run is called
+ * \param run
+ *        may use LVGL, and must not block
+ */
+void lvgl_run(uint32_t period_ms, std::function<void()> run);
+
+/**
+ * Loads the dashboard screen on its next update.  If initialize() hasn't run yet, the screen loads as soon as it's built.
+ */
+void show();
+
+/**
+ * Returns to the screen that was active before show(), on the next update.
+ */
+void hide();
+
+/**
+ * Returns true if the dashboard is the active screen.
+ */
+bool shown();
+
+/**
+ * Sets where odom (0, 0) is on the field, measured in inches from the bottom left corner.
+ *
+ * \param x
+ *        inches from the left wall, defaults to the center of the field
+ * \param y
+ *        inches from the bottom wall, defaults to the center of the field
+ */
+void origin_set(double x, double y);
+
+/**
+ * Sets the planned path drawn on the field map.
+ *
+ * \param path
+ *        poses in odom coordinates, in order
+ */
+void path_set(std::vector<ez::pose> path);
+
+/**
+ * Sets the planned path drawn on the field map.
+ *
+ * \param path
+ *        odom movements, in order
+ */
+void path_set(std::vector<ez::odom> path);
+
+/**
+ * Removes the planned path from the field map.
+ */
+void path_clear();
+
+/**
+ * Sets the current target drawn on the field map.
+ *
+ * \param target
+ *        target in odom coordinates
+ */
+void target_set(ez::pose target);
+
+/**
+ * Removes the current target from the field map.
+ */
+void target_clear();
+
+/**
+ * Sets the message line under the motor bars, the latest warning from logging.hpp.
+ * \param text
+ *        cut to fit
+ * \param color
+ *        text color, like 0xFFD000
+ */
+void message_set(const std::string& text, uint32_t color = 0xFFFFFF);
+
+/**
+ * Sets how much CPU the dashboard is allowed to use, as a percent of one core.
+ *
+ * The update period stretches (up to max_period_ms) when the measured cost goes over this.
+ *
+ * \param pct
+ *        budget in percent, defaults to 1.0
+ * \param min_period_ms
+ *        fastest the dashboard will update, defaults to 50ms
+ * \param max_period_ms
+ *        slowest the dashboard will update, defaults to 500ms
+ */
+void cpu_budget_set(double pct, uint32_t min_period_ms = 50, uint32_t max_period_ms = 500);
+
+/**
+ * Returns the measured cost of the dashboard task.
+ */
+cpu_stats cpu_get();
+
+}  // namespace dashboard
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+
+#include "EZ-Template/util.hpp"
+
+// Driving from its own task
+//  opcontrol() reads the controller at the top of its loop and gets to the drive at the bottom,
+//  after the sensors, the PID tuner and everything else, once every 10ms.  start() moves the drive
+//  to a faster task above opcontrol() that reads the sticks right before it commands the motors,
+//  through the same assist limits.  Buttons still come from input's snapshot.
+//  Every drive command, from either place, is timed from when its sticks were read, so the two can
+//  be compared with print().  Stick to motors latency is an estimate, not a measurement: a stick
+//  moves at a random time between two reads, so it waits half a poll on average, plus read_to_cmd.
+//  The controller's own radio delay comes on top and can't be seen here.
+namespace driver {
+
+/**
+ * Struct for driver latency statistics, all in microseconds.
+ */
+typedef struct latency_t {
+  uint32_t commands;          // drive commands timed
+  uint32_t changes;           // commands where a stick had moved since the last one
+  double read_to_cmd;         // mean from reading the sticks to commanding the motors, over changes
+  double read_to_cmd_jitter;  // standard deviation of that
+  uint32_t read_to_cmd_max;
+  double poll;                // mean time between stick reads
+  double poll_jitter;         // standard deviation of that
+  double latency;             // estimated mean from a stick moving to the motors hearing about it, half a poll plus read_to_cmd
+} latency_t;
+
+/**
+ * Drives from the driver task.  Stop calling assist::arcade() or assist::curvature() in opcontrol()
+ * once this is running.  Calling it again changes the controls.
+ *
+ * \param stick_type
+ *        ez::SPLIT or ez::SINGLE
+ * \param curvature
+ *        true for assist::curvature(), false for assist::arcade()
+ */
+void start(ez::e_type stick_type, bool curvature = false);
+
+/**
+ * Stops the driver task from driving, like before running an auton from opcontrol().
+ */
+void stop();
+
+/**
+ * Drives from the driver task again with the controls from the last start().
+ */
+void resume();
+
+/**
+ * Returns true while the driver task is driving.
+ */
+bool running();
+
+/**
+ * Records one drive command.  assist calls this right after it commands the motors.
+ *
+ * \param read_us
+ *        pros::micros() when the sticks behind the command were read
+ * \param changed
+ *        true if a stick moved since the last command
+ */
+void record(uint32_t read_us, bool changed);
+
+/**
+ * Returns driver latency statistics.
+ */
+latency_t latency_get();
+
+/**
+ * Clears driver latency statistics, like after switching between opcontrol() and the driver task.
+ */
+void latency_reset();
+
+/**
+ * Prints driver latency statistics to the terminal.
+ */
+void print();
+
+}  // namespace driver
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <vector>
+
+#include "api.h"
+
+// Heading from more than one IMU
+//  chassis.imu is the primary.  Extra IMUs added with add() are calibrated alongside it, and every
+//  10ms their changes in heading are corrected for each IMU's bias and scale and averaged, weighted
+//  by how noisy each one has been.  An IMU that unplugs or drifts away from the others is dropped
+//  until it agrees again.  The fused heading is written back into chassis.imu so EZ-Template's
+//  motions and odometry use it too.  EZ-Template can only read chassis.imu, so if the primary itself
+//  fails only this project's motions (motion.hpp) keep a heading, from the remaining IMUs.
+//  Whenever the drive is stopped, the gyros' bias is learned on the fly (a zero velocity update).
+//  The Heading task is an estimator (jobs.hpp), below the control jobs.  Those run first each tick,
+//  so get() there is the heading from the tick before, up to 10ms old.
+namespace heading {
+
+/**
+ * Struct for one IMU's state.
+ */
+typedef struct imu_status {
+  int port;
+  bool healthy;     // plugged in and agreeing with the others
+  double weight;    // share of the fused heading, 0 to 1
+  double bias;      // deg/s, relative to the others
+  double scale;     // relative to the others
+  double variance;  // of its rate against the fused rate, (deg/s)^2
+} imu_status;
+
+/**
+ * Struct for zero velocity update statistics.
+ */
+typedef struct zupt_stats {
+  bool stationary;         // the robot is still right now
+  uint32_t updates;        // stops bias was learned during
+  uint32_t stationary_ms;  // total time spent learning bias
+  double bias;             // deg/s, the primary IMU's current bias estimate
+  double removed;          // degrees of drift kept out of the heading while still
+} zupt_stats;
+
+/**
+ * Adds an IMU.  Call before initialize().
+ *
+ * \param port
+ *        smart port
+ */
+void add(int port);
+
+/**
+ * Calibrates the added IMUs, blocking until they finish, then starts fusing.
+ * Call after chassis.drive_imu_calibrate().
+ */
+void initialize();
+
+/**
+ * Returns the fused heading in degrees, in chassis.imu.get_rotation()'s frame.  That is
+ * chassis.drive_imu_get() without EZ-Template's IMU scaler.  Before initialize() it's the primary's
+ * rotation, or 0 if the primary isn't plugged in.
+ */
+double get();
+
+/**
+ * Returns the fused turn rate in deg/s, clockwise positive.
+ */
+double rate_get();
+
+/**
+ * Returns the acceleration in the floor's plane in g, averaged over the healthy IMUs, 0 if there are none.
+ */
+double accel_get();
+
+/**
+ * Returns the state of every IMU, the primary first.
+ */
+std::vector<imu_status> status_get();
+
+/**
+ * Turns zero velocity updates on or off, on by default.  While the drive is stopped the heading is
+ * held and every IMU's bias is learned from what it reads, so drift from warming up is corrected at
+ * every stop in a routine.
+ */
+void zupt_enable(bool enable);
+
+/**
+ * Returns zero velocity update statistics.
+ */
+zupt_stats zupt_get();
+
+/**
+ * Returns how many IMUs are currently trusted.
+ */
+int healthy_count();
+
+}  // namespace heading
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+
+#include "api.h"
+
+// Controller input
+//  update() reads every button and stick on the master controller once, at the top of the
+//  opcontrol loop, into a packed snapshot.  Presses, releases, how long buttons have been held and
+//  chords of several buttons all come from that one snapshot, so every decision in a loop sees the
+//  same controller.  Control code asks for actions by name and the binding table decides which
+//  buttons they are, so controls can be rearranged without touching opcontrol().
+//  update() is still 16 calls into PROS, 12 buttons and 4 sticks, each a copy of the last controller
+//  packet rather than a radio round trip.  EZ-Template's PID tuner reads its own buttons while it's
+//  on, and EZ-Template's curve buttons are off, assist::curves_iterate() adjusts the curves from here.
+//  update() is for the opcontrol task only.  Each snapshot is published whole and the binding table
+//  is behind a mutex, so other tasks like the driver task (driver.hpp) can read anything here.  PRESS,
+//  RELEASE and LONG_HOLD fire for one update(), so a task looping at another rate can miss or repeat
+//  them, HELD actions are the ones to use there.
+namespace input {
+
+/**
+ * A set of buttons, one bit each.
+ */
+typedef uint16_t buttons;
+
+/**
+ * Enum for when a binding fires.
+ */
+enum e_trigger { HELD = 0,      // every loop all its buttons are down
+                 PRESS = 1,     // the loop the last of its buttons goes down
+                 RELEASE = 2,   // the loop one of its buttons comes up after all were down
+                 LONG_HOLD = 3  // once, after all its buttons have been down for hold_time
+};
+
+/**
+ * Struct for one loop's controller state.
+ */
+typedef struct snapshot {
+  uint32_t time;     // ms, when it was read
+  uint32_t time_us;  // us, when the sticks were read
+  buttons held;      // down now
+  buttons pressed;   // went down this loop
+  buttons released;  // came up this loop
+  int8_t analog[4];  // LEFT_X, LEFT_Y, RIGHT_X, RIGHT_Y, -127 to 127
+} snapshot;
+
+/**
+ * Returns the set of buttons given.
+ *
+ * \param list
+ *        buttons, like {DIGITAL_UP, DIGITAL_LEFT}
+ */
+buttons mask(std::initializer_list<pros::controller_digital_e_t> list);
+
+/**
+ * Reads the controller.  Call once at the top of every opcontrol loop.
+ */
+void update();
+
+/**
+ * Returns the last snapshot.
+ */
+snapshot get();
+
+/**
+ * Returns true if every button in the set is down.
+ */
+bool held(buttons set);
+
+/**
+ * Returns true on the loop the set becomes fully held.
+ */
+bool pressed(buttons set);
+
+/**
+ * Returns true on the loop the set stops being fully held.
+ */
+bool released(buttons set);
+
+/**
+ * Returns how long the set has been fully held in ms, 0 if it isn't.
+ */
+uint32_t held_time(buttons set);
+
+/**
+ * Returns a stick's value, -127 to 127.
+ */
+int analog(pros::controller_analog_e_t channel);
+
+/**
+ * Binds an action to buttons, replacing any earlier binding for it.
+ *
+ * \param action
+ *        name control code asks for
+ * \param set
+ *        buttons, more than one is a chord
+ * \param trigger
+ *        when it fires
+ * \param hold_time
+ *        ms, only for LONG_HOLD
+ */
+void bind(const std::string& action, buttons set, e_trigger trigger, uint32_t hold_time = 0);
+
+/**
+ * Returns true if an action fired this loop.  Unbound actions never fire.
+ */
+bool action(const std::string& action);
+
+/**
+ * Prints the binding table to the terminal.
+ */
+void bindings_print();
+
+}  // namespace input
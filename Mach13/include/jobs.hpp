@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+
+#include "api.h"
+
+// Periodic jobs
+//  Every loop on the brain is a job with a period and a criticality, and its priority comes from
+//  those two, rate-monotonically: control beats estimation beats UI, and within each the faster
+//  loop wins.  The bands don't overlap, so any control loop beats any estimator.  A controller
+//  screen write can then never hold up a control tick.  Jobs share state through mailboxes instead
+//  of globals, so each value has exactly one writer.
+//  The price of ranking estimators below control is a tick of lag.  A control job and the estimator
+//  it reads both wake on the same tick, and the control job runs first, so it gets the estimate from
+//  the tick before: motion.hpp reads heading::get() and the Lady Brown job reads arm::pct_get() about
+//  10ms late.  The pose has the same lag, see tracking.hpp.
+namespace jobs {
+
+/**
+ * Enum for what a job is for, most critical first.
+ */
+enum e_criticality { CONTROL = 0,     // drives actuators, a late run is felt
+                     ESTIMATION = 1,  // turns sensors into state other jobs use
+                     ODOMETRY = 2,    // reads or writes EZ-Template's pose, so runs just below its task
+                     UI = 3 };        // screens, controller text, logging
+
+/**
+ * Returns the priority for a loop, rate-monotonically within its criticality.  ODOMETRY is one
+ * level for every rate, it has to stay between EZ-Template's task and the UI.
+ *
+ * \param period_ms
+ *        how often the loop runs
+ * \param criticality
+ *        jobs::CONTROL, jobs::ESTIMATION, jobs::ODOMETRY or jobs::UI
+ */
+uint32_t priority(uint32_t period_ms, e_criticality criticality);
+
+/**
+ * Starts a periodic job in its own task, at priority(period_ms, criticality).  Runs are timed by
+ * the task monitor.
+ *
+ * \param name
+ *        task name, also shown by the monitor
+ * \param period_ms
+ *        how often run is called
+ * \param criticality
+ *        jobs::CONTROL, jobs::ESTIMATION, jobs::ODOMETRY or jobs::UI
+ * \param run
+ *        one run of the job, must return within the period
+ */
+void add(const std::string& name, uint32_t period_ms, e_criticality criticality, std::function<void()> run);
+
+/**
+ * Prints every job and its priority to the terminal.
+ */
+void print();
+
+/**
+ * A mailbox between jobs.  send() queues a message, receive() takes them in order, and latest()
+ * returns the last one sent without taking it, for state that's read more than it changes.
+ * When the queue is full the oldest message is dropped.
+ */
+template <typename T>
+class mailbox {
+ public:
+  /**
+   * \param initial
+   *        what latest() returns before anything is sent
+   * \param depth
+   *        messages held before the oldest is dropped
+   */
+  explicit mailbox(T initial = T(), size_t depth = 8) : last(initial), depth(depth) {}
+
+  /**
+   * Sends a message.
+   */
+  void send(const T& message) {
+    mutex.take();
+    if (queue.size() >= depth) queue.pop_front();
+    queue.push_back(message);
+    last = message;
+    sent++;
+    mutex.give();
+  }
+
+  /**
+   * Takes the oldest message, returns false if there isn't one.
+   */
+  bool receive(T& message) {
+    mutex.take();
+    bool any = !queue.empty();
+    if (any) {
+      message = queue.front();
+      queue.pop_front();
+    }
+    mutex.give();
+    return any;
+  }
+
+  /**
+   * Returns the last message sent, taken or not.
+   */
+  T latest() {
+    mutex.take();
+    T copy = last;
+    mutex.give();
+    return copy;
+  }
+
+  /**
+   * Returns how many messages have ever been sent, to tell when latest() changed.
+   */
+  uint32_t count() {
+    mutex.take();
+    uint32_t copy = sent;
+    mutex.give();
+    return copy;
+  }
+
+ private:
+  pros::Mutex mutex;
+  std::deque<T> queue;
+  T last;
+  size_t depth;
+  uint32_t sent = 0;
+};
+
+}  // namespace jobs
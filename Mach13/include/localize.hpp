@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+
+#include "EZ-Template/util.hpp"
+#include "mcl.hpp"
+
+// Field localization
+//  Odometry drifts and never notices being pushed.  Distance sensors pointed at the walls are run
+//  through a particle filter (mcl.hpp) against a map of the field, moved by odometry between
+//  readings, so the robot knows where it is on the field rather than only how far it has driven.
+//  Once the particles agree, odometry is nudged toward them a little each update, so autons and
+//  every reader of the pose get the corrected position without changing anything.  Heading is left
+//  to the IMUs (heading.hpp).
+//  Test changes with tools/mcl_bench before taking them to the robot.
+namespace localize {
+
+/**
+ * Struct for localization statistics.
+ */
+typedef struct stats_t {
+  uint32_t updates;
+  uint32_t corrections;  // updates that moved odometry
+  uint32_t resets;       // times odometry was set and the particles followed
+  uint32_t last_us;      // how long the last update took
+  uint32_t max_us;
+  double spread;         // inches, how much the particles disagree
+  double ess;            // effective particle count
+  int readings;          // sensors with a usable reading last update
+} stats_t;
+
+/**
+ * Adds a distance sensor.  Call before initialize().
+ *
+ * \param port
+ *        smart port
+ * \param x
+ *        inches right of the robot's center
+ * \param y
+ *        inches forward of the robot's center
+ * \param theta
+ *        degrees the sensor faces, 0 is forward, clockwise positive
+ * \param max_range
+ *        inches, readings past this are ignored.  The sensor is rated to about 78in
+ */
+void sensor_add(int port, double x, double y, double theta, double max_range = 78.0);
+
+/**
+ * Starts the filter.  Call once odometry is running.
+ */
+void initialize();
+
+/**
+ * Tells the filter where on the field the robot is right now, like at the start of an auton.
+ *
+ * \param field_pose
+ *        inches and degrees, (0, 0) is the center of the field, theta 0 faces +y
+ */
+void start_set(mcl::pose field_pose);
+
+/**
+ * Forgets where the robot is and searches the whole field, keeping the IMU's heading.  Give it
+ * a few seconds, ideally moving, before trusting it.  The field looks much the same from a few
+ * places, so now and then it settles on the wrong one, check field_get() against where the robot
+ * should be.
+ */
+void relocalize();
+
+/**
+ * Sets whether odometry is corrected, and how hard.
+ *
+ * \param enabled
+ *        true to correct odometry, false to only estimate
+ * \param gain
+ *        0 to 1, the share of the difference removed each update
+ */
+void correction_set(bool enabled, double gain = 0.2);
+
+/**
+ * Returns the estimated pose on the field.
+ */
+mcl::pose field_get();
+
+/**
+ * Returns the estimated pose in odometry's frame, what odometry would read if it hadn't drifted.
+ */
+ez::pose odom_get();
+
+/**
+ * Returns localization statistics.
+ */
+stats_t stats_get();
+
+/**
+ * Prints the estimate and statistics to the terminal.
+ */
+void print();
+
+}  // namespace localize
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "telemetry_codec.hpp"
+
+// Log wire format, shared by the robot (logging.hpp) and the host decoder (tools/log_decode.cpp)
+//
+//  Frames are built like telemetry's (telemetry_codec.hpp): [type][seq][payload][crc16 hi][crc16 lo],
+//  COBS encoded and ended with a 0x00 byte.
+//
+//  'F' format  site id, level, line, file, format string.  Sent to each sink before the site's first record
+//  'R' record  site id, time in ms, then the arguments in the order the format uses them
+//  'L' lost    how many records were dropped because the queue was full
+//
+//  Arguments are binary and typed by their conversion in the format: %d %i %c as zigzag varints,
+//  %u %x %X %o %p as varints, %f %e %g %a as floats, %s as a length and bytes.  The robot only
+//  formats text for a sink that shows text, and each format string is sent once, not per record.
+namespace logging {
+
+const size_t ARGS_MAX = 8;
+const size_t STRING_MAX = 48;  // characters of a %s argument that are kept
+const size_t TEXT_MAX = 160;   // characters of a rendered line
+
+enum e_level : uint8_t { DEBUG = 0,
+                         INFO = 1,
+                         WARN = 2,
+                         ERROR = 3,
+                         OFF = 4 };
+
+enum frame_type : uint8_t { FRAME_FORMAT = 'F',
+                            FRAME_RECORD = 'R',
+                            FRAME_LOST = 'L' };
+
+/**
+ * Enum for how a conversion's argument is sent.
+ */
+enum e_kind : uint8_t { KIND_NONE = 0,     // end of the format
+                        KIND_SIGNED = 1,   // d i c
+                        KIND_UNSIGNED = 2, // u x X o p
+                        KIND_FLOAT = 3,    // f F e E g G a A
+                        KIND_STRING = 4,   // s
+                        KIND_INVALID = 5 };
+
+/**
+ * Struct for one conversion in a format string.
+ */
+typedef struct conversion {
+  e_kind kind;
+  size_t start;  // index of the '%'
+  size_t end;    // one past the conversion character
+} conversion;
+
+/**
+ * Finds the next conversion at or after pos, skipping %%.  Returns KIND_NONE at the end, and
+ * KIND_INVALID for anything this format can't carry, like * widths or 64 bit lengths.
+ */
+constexpr conversion conversion_next(const char* format, size_t pos) {
+  while (format[pos] != '\0') {
+    if (format[pos] != '%') {
+      pos++;
+      continue;
+    }
+    size_t start = pos++;
+    if (format[pos] == '%') {
+      pos++;
+      continue;
+    }
+    while (format[pos] == '-' || format[pos] == '+' || format[pos] == ' ' || format[pos] == '#' || format[pos] == '0') pos++;
+    while ((format[pos] >= '0' && format[pos] <= '9') || format[pos] == '.') pos++;
+    if (format[pos] == '*') return {KIND_INVALID, start, pos + 1};
+    if (format[pos] == 'h') {
+      pos++;
+      if (format[pos] == 'h') pos++;
+    } else if (format[pos] == 'l' || format[pos] == 'z') {
+      pos++;
+      if (format[pos] == 'l') return {KIND_INVALID, start, pos + 1};  // 64 bits
+    } else if (format[pos] == 'j' || format[pos] == 'L') {
+      return {KIND_INVALID, start, pos + 1};
+    }
+    char c = format[pos];
+    size_t end = pos + 1;
+    switch (c) {
+      case 'd': case 'i': case 'c':
+        return {KIND_SIGNED, start, end};
+      case 'u': case 'x': case 'X': case 'o': case 'p':
+        return {KIND_UNSIGNED, start, end};
+      case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+        return {KIND_FLOAT, start, end};
+      case 's':
+        return {KIND_STRING, start, end};
+      default:
+        return {KIND_INVALID, start, end};
+    }
+  }
+  return {KIND_NONE, pos, pos};
+}
+
+/**
+ * Writes a string as a length and bytes, cut to max characters.
+ */
+inline void string_write(telemetry::frame_writer& frame, const char* text, size_t max) {
+  size_t length = text == nullptr ? 0 : strnlen(text, max);
+  frame.varint(length);
+  for (size_t i = 0; i < length; i++) frame.u8((uint8_t)text[i]);
+}
+
+/**
+ * Reads a string written by string_write().
+ */
+inline std::string string_read(telemetry::frame_reader& frame) {
+  uint32_t length = frame.varint();
+  std::string text;
+  for (uint32_t i = 0; i < length && frame.ok; i++) text += (char)frame.u8();
+  return text;
+}
+
+/**
+ * Formats a record's arguments with its format string, reading them from frame.  Returns the text,
+ * cut to TEXT_MAX characters.
+ */
+inline std::string render(const char* format, telemetry::frame_reader& frame) {
+  std::string out;
+  char spec[24], piece[TEXT_MAX];
+  size_t pos = 0;
+  while (out.size() < TEXT_MAX) {
+    conversion c = conversion_next(format, pos);
+    // Literal text up to the conversion, with %% turned into %
+    for (size_t i = pos; i < c.start; i++) {
+      out += format[i];
+      if (format[i] == '%' && format[i + 1] == '%') i++;
+    }
+    if (c.kind == KIND_NONE || c.kind == KIND_INVALID) break;
+
+    // The spec without its length, every value is 32 bits on the wire
+    size_t n = 0;
+    for (size_t i = c.start; i < c.end && n < sizeof(spec) - 1; i++) {
+      if (format[i] != 'h' && format[i] != 'l' && format[i] != 'z') spec[n++] = format[i];
+    }
+    spec[n] = '\0';
+    switch (c.kind) {
+      case KIND_SIGNED:
+        snprintf(piece, sizeof(piece), spec, (int)frame.svarint());
+        break;
+      case KIND_UNSIGNED:
+        if (format[c.end - 1] == 'p')
+          snprintf(piece, sizeof(piece), "0x%08x", (unsigned)frame.varint());
+        else
+          snprintf(piece, sizeof(piece), spec, (unsigned)frame.varint());
+        break;
+      case KIND_FLOAT:
+        snprintf(piece, sizeof(piece), spec, (double)frame.f32());
+        break;
+      default:
+        snprintf(piece, sizeof(piece), spec, string_read(frame).c_str());
+        break;
+    }
+    if (!frame.ok) break;
+    out += piece;
+    pos = c.end;
+  }
+  if (out.size() > TEXT_MAX) out.resize(TEXT_MAX);
+  return out;
+}
+
+/**
+ * Returns the name of a level.
+ */
+inline const char* level_name(uint8_t level) {
+  static const char* names[] = {"DEBUG", "INFO", "WARN", "ERROR"};
+  return level < 4 ? names[level] : "?";
+}
+
+}  // namespace logging
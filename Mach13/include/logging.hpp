@@ -0,0 +1,216 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#include "log_codec.hpp"
+
+// Logging
+//  LOGD, LOGI, LOGW and LOGE("Module: format", args...) log at debug, info, warning and error, with
+//  printf formats and no newline.
+//  - The format is checked against the arguments while compiling, a mismatch doesn't build.
+//  - Levels below LOGGING_LEVEL aren't compiled in at all.  Debug logs are off unless the Makefile's
+//    EXTRA_CXXFLAGS has -DLOGGING_LEVEL=0.
+//  - Arguments are only evaluated when a sink wants the level.
+//  - The caller only copies its arguments into a binary record (log_codec.hpp) and queues it.
+//  A low priority task hands records to the sinks: the terminal as text or binary, the SD card as
+//  binary, and the dashboard shows the latest warning.  tools/log_decode.cpp turns binary back into text.
+#ifndef LOGGING_LEVEL
+#define LOGGING_LEVEL 1  // info
+#endif
+
+namespace logging {
+
+const size_t RECORD_MAX = 96;  // bytes of encoded arguments in one record
+
+/**
+ * Struct for where a log call is.  Each call keeps one, made by the macros.
+ */
+typedef struct site {
+  e_level level;
+  const char* file;
+  int line;
+  const char* format;  // set the first time it logs
+  int id;              // -1 until the first time it logs
+} site;
+
+/**
+ * Struct for logging statistics.
+ */
+typedef struct stats_t {
+  uint32_t records;   // queued
+  uint32_t dropped;   // the queue was full
+  uint32_t sites;     // log calls that have logged
+  uint32_t sd_bytes;  // written to the SD card
+} stats_t;
+
+/**
+ * Sets what's logged to the terminal.
+ *
+ * \param level
+ *        lowest level shown, logging::OFF for nothing
+ * \param binary
+ *        true to send binary frames for tools/log_decode.cpp, false for text
+ */
+void terminal_set(e_level level, bool binary = false);
+
+/**
+ * Starts logging to a new file on the SD card, binary, for tools/log_decode.cpp.  Returns false if
+ * the file can't be opened.
+ *
+ * \param level
+ *        lowest level written
+ * \param path
+ *        file, replaced if it exists
+ */
+bool sd_start(e_level level = INFO, const std::string& path = "/usd/m13_log.bin");
+
+/**
+ * Stops logging to the SD card and closes the file.
+ */
+void sd_stop();
+
+/**
+ * Sets what the dashboard shows, the latest record at or above the level.
+ *
+ * \param level
+ *        lowest level shown, logging::OFF for nothing
+ */
+void screen_set(e_level level);
+
+/**
+ * Returns logging statistics.
+ */
+stats_t stats_get();
+
+// Below is what the macros use
+
+// The lowest level any sink wants, kept up to date by the sink setters
+inline volatile uint8_t lowest = INFO;
+
+inline bool enabled(e_level level) { return level >= lowest; }
+
+/**
+ * Queues an encoded record.  Use the macros.
+ */
+void submit(site& s, const char* format, const uint8_t* args, size_t length, bool ok);
+
+// Not constexpr, so a format that doesn't match its arguments fails to compile here
+void format_does_not_match_arguments();
+
+// long is 32 bits on the brain, anything wider doesn't fit the encoding
+template <typename T>
+constexpr bool fits(e_kind kind) {
+  using U = std::remove_cv_t<std::decay_t<T>>;
+  switch (kind) {
+    case KIND_SIGNED:
+      return (std::is_integral_v<U> || std::is_enum_v<U>) && sizeof(U) <= sizeof(long);
+    case KIND_UNSIGNED:
+      return ((std::is_integral_v<U> || std::is_enum_v<U>) && sizeof(U) <= sizeof(long)) || (std::is_pointer_v<U> && sizeof(U) <= 4);
+    case KIND_FLOAT:
+      return std::is_floating_point_v<U>;
+    case KIND_STRING:
+      return std::is_same_v<U, const char*> || std::is_same_v<U, char*> || std::is_same_v<U, std::string>;
+    default:
+      return false;
+  }
+}
+
+template <typename... Args>
+constexpr bool fits_nth(size_t index, e_kind kind) {
+  size_t i = 0;
+  bool result = false;
+  ((result = i++ == index ? fits<Args>(kind) : result), ...);
+  return result;
+}
+
+/**
+ * A format string checked against its argument types while compiling.
+ */
+template <typename... Args>
+struct checked_format {
+  const char* text;
+  e_kind kinds[ARGS_MAX + 1] = {};
+
+  template <size_t N>
+  consteval checked_format(const char (&format)[N]) : text(format) {
+    static_assert(sizeof...(Args) <= ARGS_MAX, "too many log arguments");
+    size_t pos = 0, count = 0;
+    while (true) {
+      conversion c = conversion_next(format, pos);
+      if (c.kind == KIND_NONE) break;
+      if (c.kind == KIND_INVALID || count >= sizeof...(Args) || !fits_nth<Args...>(count, c.kind)) format_does_not_match_arguments();
+      kinds[count++] = c.kind;
+      pos = c.end;
+    }
+    if (count != sizeof...(Args)) format_does_not_match_arguments();
+  }
+};
+
+template <typename T>
+void encode(telemetry::frame_writer& frame, e_kind kind, const T& value) {
+  using U = std::remove_cv_t<std::decay_t<T>>;
+  if constexpr (std::is_floating_point_v<U>) {
+    frame.f32((float)value);
+  } else if constexpr (std::is_same_v<U, std::string>) {
+    string_write(frame, value.c_str(), STRING_MAX);
+  } else if constexpr (std::is_pointer_v<U>) {
+    if constexpr (std::is_same_v<U, const char*> || std::is_same_v<U, char*>) {
+      if (kind == KIND_STRING) return string_write(frame, value, STRING_MAX);
+    }
+    frame.varint((uint32_t)(uintptr_t)value);
+  } else if (kind == KIND_SIGNED) {
+    frame.svarint((int32_t)value);
+  } else {
+    frame.varint((uint32_t)value);
+  }
+}
+
+template <typename... Args>
+void write(site& s, checked_format<std::type_identity_t<Args>...> format, const Args&... args) {
+  uint8_t buffer[RECORD_MAX];
+  telemetry::frame_writer frame(buffer, sizeof(buffer));
+  size_t i = 0;
+  (encode(frame, format.kinds[i++], args), ...);
+  submit(s, format.text, buffer, frame.len, frame.ok);
+}
+
+// Only checks the format, for levels that are compiled out
+template <typename... Args>
+constexpr void check(checked_format<std::type_identity_t<Args>...>, const Args&...) {}
+
+}  // namespace logging
+
+#define LOGGING_AT_(level, ...)                                                       \
+  do {                                                                                \
+    if (logging::enabled(level)) {                                                    \
+      static logging::site logging_site_ = {level, __FILE__, __LINE__, nullptr, -1};  \
+      logging::write(logging_site_, __VA_ARGS__);                                     \
+    }                                                                                 \
+  } while (0)
+#define LOGGING_OUT_(...)                     \
+  do {                                        \
+    if (false) logging::check(__VA_ARGS__);   \
+  } while (0)
+
+#if LOGGING_LEVEL <= 0
+#define LOGD(...) LOGGING_AT_(logging::DEBUG, __VA_ARGS__)
+#else
+#define LOGD(...) LOGGING_OUT_(__VA_ARGS__)
+#endif
+#if LOGGING_LEVEL <= 1
+#define LOGI(...) LOGGING_AT_(logging::INFO, __VA_ARGS__)
+#else
+#define LOGI(...) LOGGING_OUT_(__VA_ARGS__)
+#endif
+#if LOGGING_LEVEL <= 2
+#define LOGW(...) LOGGING_AT_(logging::WARN, __VA_ARGS__)
+#else
+#define LOGW(...) LOGGING_OUT_(__VA_ARGS__)
+#endif
+#if LOGGING_LEVEL <= 3
+#define LOGE(...) LOGGING_AT_(logging::ERROR, __VA_ARGS__)
+#else
+#define LOGE(...) LOGGING_OUT_(__VA_ARGS__)
+#endif
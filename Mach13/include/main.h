@@ -46,6 +46,24 @@
 // More includes here...
 #include "autons.hpp"
 #include "subsystems.hpp"
+#include "boot.hpp"
+#include "config.hpp"
+#include "dashboard.hpp"
+#include "telemetry.hpp"
+#include "motion.hpp"
+#include "slip.hpp"
+#include "assist.hpp"
+#include "heading.hpp"
+#include "input.hpp"
+#include "sensors.hpp"
+#include "arm.hpp"
+#include "monitor.hpp"
+#include "jobs.hpp"
+#include "tracking.hpp"
+#include "localize.hpp"
+#include "driver.hpp"
+#include "motors.hpp"
+#include "logging.hpp"
 
 
 /**
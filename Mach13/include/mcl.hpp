@@ -0,0 +1,445 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Monte Carlo localization
+//  Shared by the robot (localize.hpp) and the host tools, so this only depends on the standard library.
+//  A cloud of guesses (particles) at the robot's pose is moved by odometry, with noise, and weighted
+//  by how well the distance sensor readings match the ranges a ray cast against the field map
+//  expects from each guess.  The cloud is resampled toward the likely guesses only once the weights
+//  get lopsided, and when readings stop matching anywhere (the robot was pushed, or started in the
+//  wrong place) random guesses are mixed in so it can find itself again.
+//  Units are inches and degrees in the field frame: (0, 0) is the center of the field, theta 0 is
+//  +y and clockwise is positive, like odometry.
+namespace mcl {
+
+/**
+ * Struct for a pose on the field.
+ */
+typedef struct pose {
+  double x;
+  double y;
+  double theta;
+} pose;
+
+/**
+ * Struct for a wall or the side of a field element.
+ */
+typedef struct segment {
+  float ax, ay;
+  float bx, by;
+} segment;
+
+/**
+ * Struct for where a distance sensor is mounted, relative to the robot's center.
+ */
+typedef struct mount {
+  double x;          // inches to the right
+  double y;          // inches forward
+  double theta;      // degrees the sensor faces, 0 is forward, clockwise positive
+  double max_range;  // inches, readings past this are ignored
+} mount;
+
+/**
+ * Struct for filter tuning.
+ */
+typedef struct constants_t {
+  int particles = 300;
+  double sigma_min = 0.6;         // inches of sensor noise up close
+  double sigma_pct = 0.05;        // plus this share of the range
+  double hit_weight = 0.9;        // share of readings that are the map, the rest are robots and noise
+  double turn_noise = 0.05;       // degrees of turn error per degree turned
+  double turn_drive_noise = 0.2;  // degrees of turn error per inch driven
+  double drive_noise = 0.05;      // inches of drive error per inch driven
+  double slide_noise = 0.02;      // inches of sideways error per inch driven
+  double resample_ess = 0.5;      // resample once the effective particle count drops below this share
+  double slow_rate = 0.01;        // long average of how well readings match
+  double fast_rate = 0.2;         // short average of how well readings match
+  double inject_below = 0.5;      // random particles are added once the short average falls below this share of the long one
+  double inject_max = 0.25;       // most of the particles replaced at once
+} constants_t;
+
+/**
+ * Fast random numbers for the filter, xorshift64*.
+ */
+class rng {
+ public:
+  explicit rng(uint64_t seed = 0x9E3779B97F4A7C15ull) : state(seed ? seed : 1) {}
+
+  uint64_t next() {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545F4914F6CDD1Dull;
+  }
+
+  /**
+   * Returns a uniform number from 0 to 1.
+   */
+  double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+
+  /**
+   * Returns a normal number with mean 0 and standard deviation 1.
+   */
+  double normal() {
+    if (has_spare) {
+      has_spare = false;
+      return spare;
+    }
+    double u = std::max(uniform(), 1e-12), v = uniform();
+    double r = std::sqrt(-2.0 * std::log(u));
+    spare = r * std::sin(2.0 * M_PI * v);
+    has_spare = true;
+    return r * std::cos(2.0 * M_PI * v);
+  }
+
+ private:
+  uint64_t state;
+  double spare = 0.0;
+  bool has_spare = false;
+};
+
+/**
+ * The field as line segments, plus solid boxes particles can't be inside.
+ */
+class field_map {
+ public:
+  /**
+   * Adds a segment.
+   */
+  void segment_add(double ax, double ay, double bx, double by) {
+    segments.push_back({(float)ax, (float)ay, (float)bx, (float)by});
+  }
+
+  /**
+   * Adds a solid rectangle, like a post.
+   *
+   * \param x
+   *        center
+   * \param y
+   *        center
+   * \param width
+   *        along x
+   * \param height
+   *        along y
+   */
+  void box_add(double x, double y, double width, double height) {
+    double l = x - width / 2, r = x + width / 2, b = y - height / 2, t = y + height / 2;
+    segment_add(l, b, r, b);
+    segment_add(r, b, r, t);
+    segment_add(r, t, l, t);
+    segment_add(l, t, l, b);
+    boxes.push_back({(float)l, (float)b, (float)r, (float)t});
+  }
+
+  /**
+   * Returns true if a point is on the field and not inside a box.
+   */
+  bool free(double x, double y, double margin = 0.0) const {
+    if (fabs(x) > half - margin || fabs(y) > half - margin) return false;
+    for (auto& b : boxes) {
+      if (x > b.ax - margin && x < b.bx + margin && y > b.ay - margin && y < b.by + margin) return false;
+    }
+    return true;
+  }
+
+  /**
+   * The perimeter and the ladder's legs.  Measure your own field, element positions vary a little.
+   */
+  static field_map high_stakes() {
+    field_map m;
+    m.half = 70.2;  // Inside of the perimeter, 12 foot field less the wall
+    m.segment_add(-m.half, -m.half, m.half, -m.half);
+    m.segment_add(m.half, -m.half, m.half, m.half);
+    m.segment_add(m.half, m.half, -m.half, m.half);
+    m.segment_add(-m.half, m.half, -m.half, -m.half);
+    // Ladder legs, on the tile seams around the center
+    m.box_add(24.0, 0.0, 2.5, 2.5);
+    m.box_add(-24.0, 0.0, 2.5, 2.5);
+    m.box_add(0.0, 24.0, 2.5, 2.5);
+    m.box_add(0.0, -24.0, 2.5, 2.5);
+    return m;
+  }
+
+  std::vector<segment> segments;
+  std::vector<segment> boxes;  // as lower left and upper right corners
+  double half = 72.0;          // half the field's width
+};
+
+/**
+ * Casts one ray per entry against every segment of the map.  The loops are plain arrays with no
+ * branches in the inner loop, but the robot is built with -Os for ARMv7 and without -ffast-math, so
+ * they stay scalar there.  Check the real cost on the brain with localize::print() (stats last_us).
+ *
+ * \param map
+ *        the field
+ * \param count
+ *        rays
+ * \param ox, oy
+ *        ray origins
+ * \param dx, dy
+ *        unit ray directions
+ * \param out
+ *        distance to the first hit, max_range if nothing is closer
+ * \param max_range
+ *        longest ray
+ */
+inline void cast(const field_map& map, int count, const float* __restrict ox, const float* __restrict oy, const float* __restrict dx,
+                 const float* __restrict dy, float* __restrict out, float max_range) {
+  for (int i = 0; i < count; i++) out[i] = max_range;
+  for (const segment& s : map.segments) {
+    const float ex = s.bx - s.ax, ey = s.by - s.ay;
+    for (int i = 0; i < count; i++) {
+      // o + t d = a + u e
+      float wx = s.ax - ox[i], wy = s.ay - oy[i];
+      float denom = dx[i] * ey - dy[i] * ex;
+      float inv = 1.0f / denom;
+      float t = (wx * ey - wy * ex) * inv;
+      float u = (wx * dy[i] - wy * dx[i]) * inv;
+      bool hit = t > 0.0f && u >= 0.0f && u <= 1.0f && t < out[i];  // Parallel rays give inf or nan and fail
+      out[i] = hit ? t : out[i];
+    }
+  }
+}
+
+/**
+ * The particle filter.
+ */
+class filter {
+ public:
+  /**
+   * \param map
+   *        the field
+   * \param mounts
+   *        every distance sensor, in the order update() gets their readings
+   * \param constants
+   *        tuning
+   * \param seed
+   *        for the random numbers
+   */
+  filter(const field_map& map, const std::vector<mount>& mounts, constants_t constants = {}, uint64_t seed = 1)
+      : map(map), mounts(mounts), c(constants), random(seed) {
+    resize(c.particles);
+  }
+
+  /**
+   * Spreads the particles around a pose.
+   *
+   * \param center
+   *        best guess
+   * \param spread
+   *        inches of standard deviation in x and y
+   * \param theta_spread
+   *        degrees of standard deviation in theta
+   */
+  void reset(pose center, double spread, double theta_spread) {
+    for (int i = 0; i < n; i++) {
+      do {
+        x[i] = center.x + spread * random.normal();
+        y[i] = center.y + spread * random.normal();
+      } while (!map.free(x[i], y[i]) && spread > 0.0);
+      theta[i] = center.theta + theta_spread * random.normal();
+      w[i] = 1.0 / n;
+    }
+    slow = fast = 0.0;
+  }
+
+  /**
+   * Spreads the particles over the whole field, for when the robot has no idea where it is.
+   * Theta stays near what the IMU says, which also tells mirror image poses apart.
+   *
+   * \param heading
+   *        degrees, the IMU's heading in the field frame
+   * \param theta_spread
+   *        degrees of standard deviation
+   */
+  void reset_global(double heading, double theta_spread = 3.0) {
+    for (int i = 0; i < n; i++) random_particle(i, heading, theta_spread);
+    slow = fast = 0.0;
+  }
+
+  /**
+   * Moves every particle by odometry's motion since the last call, plus noise.
+   *
+   * \param forward
+   *        inches along the robot's heading
+   * \param right
+   *        inches sideways, right positive
+   * \param turn
+   *        degrees clockwise
+   */
+  void predict(double forward, double right, double turn) {
+    double moved = std::hypot(forward, right);
+    double turn_sd = c.turn_noise * fabs(turn) + c.turn_drive_noise * moved;
+    double drive_sd = c.drive_noise * moved;
+    double slide_sd = c.slide_noise * moved;
+    for (int i = 0; i < n; i++) {
+      double t = turn + turn_sd * random.normal();
+      double f = forward + drive_sd * random.normal();
+      double r = right + slide_sd * random.normal();
+      double mid = (theta[i] + t / 2.0) * (M_PI / 180.0);
+      double s = std::sin(mid), k = std::cos(mid);
+      x[i] += f * s + r * k;
+      y[i] += f * k - r * s;
+      theta[i] += t;
+    }
+  }
+
+  /**
+   * Weights the particles by a set of readings, and resamples when the weights get lopsided.
+   *
+   * \param ranges
+   *        inches, one per mount, negative or nan for no reading
+   */
+  void update(const double* ranges) {
+    std::fill(log_likelihood.begin(), log_likelihood.end(), 0.0f);
+    int used = 0;
+    for (size_t m = 0; m < mounts.size(); m++) {
+      double z = ranges[m];
+      if (!(z > 0.0) || z >= mounts[m].max_range) continue;  // Nothing in range tells the filter very little
+      used++;
+
+      // Rays from where this sensor would be on every particle
+      const mount& mt = mounts[m];
+      for (int i = 0; i < n; i++) {
+        double h = theta[i] * (M_PI / 180.0);
+        double s = std::sin(h), k = std::cos(h);
+        ox[i] = x[i] + mt.x * k + mt.y * s;
+        oy[i] = y[i] - mt.x * s + mt.y * k;
+        double a = (theta[i] + mt.theta) * (M_PI / 180.0);
+        dx[i] = std::sin(a);
+        dy[i] = std::cos(a);
+      }
+      cast(map, n, ox.data(), oy.data(), dx.data(), dy.data(), expected.data(), (float)(mt.max_range * 1.5));
+
+      // Mostly a bell around the expected range, a little flat for readings off robots
+      double sigma = c.sigma_min + c.sigma_pct * z;
+      float inv_var = (float)(0.5 / (sigma * sigma));
+      float hit = (float)(c.hit_weight / (sigma * std::sqrt(2.0 * M_PI)));
+      float miss = (float)((1.0 - c.hit_weight) / mt.max_range);
+      for (int i = 0; i < n; i++) {
+        float e = (float)z - expected[i];
+        log_likelihood[i] += std::log(hit * std::exp(-e * e * inv_var) + miss);
+      }
+    }
+    if (used == 0) return;
+
+    // Normalize in log space so products of small likelihoods don't underflow
+    float best = *std::max_element(log_likelihood.begin(), log_likelihood.begin() + n);
+    double total = 0.0, average = 0.0;
+    for (int i = 0; i < n; i++) {
+      w[i] *= std::exp(log_likelihood[i] - best);
+      total += w[i];
+      average += std::exp(log_likelihood[i] / used);  // Per reading, so the averages don't depend on how many sensors saw something
+    }
+    average /= n;
+    if (!(total > 0.0)) {
+      for (int i = 0; i < n; i++) w[i] = 1.0 / n;
+    } else {
+      for (int i = 0; i < n; i++) w[i] /= total;
+    }
+
+    // Falling match quality means the robot isn't where the particles are
+    slow = slow == 0.0 ? average : slow + c.slow_rate * (average - slow);
+    fast = fast == 0.0 ? average : fast + c.fast_rate * (average - fast);
+    double inject = std::clamp(1.0 - fast / (c.inject_below * slow), 0.0, c.inject_max);
+
+    if (ess() < c.resample_ess * n || inject > 0.0) resample(inject);
+  }
+
+  /**
+   * Returns the weighted mean pose.
+   */
+  pose estimate() const {
+    double sx = 0, sy = 0, ss = 0, sc = 0;
+    for (int i = 0; i < n; i++) {
+      sx += w[i] * x[i];
+      sy += w[i] * y[i];
+      ss += w[i] * std::sin(theta[i] * (M_PI / 180.0));
+      sc += w[i] * std::cos(theta[i] * (M_PI / 180.0));
+    }
+    return {sx, sy, std::atan2(ss, sc) * (180.0 / M_PI)};
+  }
+
+  /**
+   * Returns the weighted standard deviation of the particles' positions, in inches.
+   */
+  double spread() const {
+    pose m = estimate();
+    double v = 0;
+    for (int i = 0; i < n; i++) v += w[i] * ((x[i] - m.x) * (x[i] - m.x) + (y[i] - m.y) * (y[i] - m.y));
+    return std::sqrt(v);
+  }
+
+  /**
+   * Returns the effective number of particles, n when every weight is equal and 1 when one has them all.
+   */
+  double ess() const {
+    double sum = 0;
+    for (int i = 0; i < n; i++) sum += w[i] * w[i];
+    return sum > 0 ? 1.0 / sum : 0.0;
+  }
+
+  /**
+   * Returns how many particles there are.
+   */
+  int size() const { return n; }
+
+ private:
+  void resize(int count) {
+    n = count;
+    for (auto* v : {&x, &y, &theta, &w}) v->assign(n, 0.0);
+    for (auto* v : {&ox, &oy, &dx, &dy, &expected, &log_likelihood}) v->assign(n, 0.0f);
+    next_x.assign(n, 0.0);
+    next_y.assign(n, 0.0);
+    next_theta.assign(n, 0.0);
+    reset({0, 0, 0}, 24.0, 5.0);
+  }
+
+  void random_particle(int i, double heading, double theta_spread) {
+    do {
+      x[i] = (random.uniform() * 2.0 - 1.0) * map.half;
+      y[i] = (random.uniform() * 2.0 - 1.0) * map.half;
+    } while (!map.free(x[i], y[i], 6.0));
+    theta[i] = heading + theta_spread * random.normal();
+    w[i] = 1.0 / n;
+  }
+
+  // Low variance resampling, with a share of the new particles drawn at random
+  void resample(double inject) {
+    double heading = estimate().theta;
+    double step = 1.0 / n;
+    double r = random.uniform() * step;
+    double cumulative = w[0];
+    int j = 0;
+    for (int i = 0; i < n; i++) {
+      double target = r + i * step;
+      while (target > cumulative && j < n - 1) cumulative += w[++j];
+      next_x[i] = x[j];
+      next_y[i] = y[j];
+      next_theta[i] = theta[j];
+    }
+    x.swap(next_x);
+    y.swap(next_y);
+    theta.swap(next_theta);
+    for (int i = 0; i < n; i++) {
+      w[i] = step;
+      if (inject > 0.0 && random.uniform() < inject) random_particle(i, heading, 3.0);
+    }
+  }
+
+  field_map map;
+  std::vector<mount> mounts;
+  constants_t c;
+  rng random;
+  int n = 0;
+  double slow = 0.0, fast = 0.0;
+  std::vector<double> x, y, theta, w;
+  std::vector<double> next_x, next_y, next_theta;
+  std::vector<float> ox, oy, dx, dy, expected, log_likelihood;
+};
+
+}  // namespace mcl
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "api.h"
+
+// Task monitor
+//  Periodic loops call begin() and end() around each run, and the monitor records how long every
+//  run took in a histogram, how often a run started later than its period allows or ran past its
+//  deadline, and how much CPU each loop uses.  Tasks that can't be instrumented, like
+//  EZ-Template's, can still be watched by name for their state and stack.  Once a second the
+//  numbers are refreshed, and can be printed, appended to a CSV on the SD card and shown on the
+//  brain.  A watchdog action can be attached to a loop that keeps missing its deadline.
+namespace monitor {
+
+/**
+ * Run time histogram bin edges in microseconds, the last bin is everything slower.
+ */
+inline constexpr uint32_t HISTOGRAM_EDGES[] = {100, 250, 500, 1000, 2000, 5000, 10000};
+inline constexpr int HISTOGRAM_BINS = sizeof(HISTOGRAM_EDGES) / sizeof(HISTOGRAM_EDGES[0]) + 1;
+
+/**
+ * Struct for one task's statistics.
+ */
+typedef struct job_stats {
+  std::string name;
+  bool instrumented;    // calls begin() and end(), false for watched tasks
+  uint32_t period_ms;
+  uint32_t deadline_us;
+  uint32_t runs;
+  uint32_t late;        // runs that started more than half a period late
+  uint32_t overruns;    // runs longer than the deadline
+  uint32_t last_us;
+  uint32_t avg_us;
+  uint32_t max_us;
+  uint32_t histogram[HISTOGRAM_BINS];
+  double cpu_pct;       // of one core, over the last second
+  int stack_free;       // words never used, -1 if the kernel can't say
+  int state;            // pros::task_state_e_t
+} job_stats;
+
+/**
+ * Registers the calling task's loop.  Call from inside the task, before its loop.  Registering a
+ * name again, like opcontrol() starting a second time, returns the same id.
+ *
+ * \param name
+ *        shown in reports
+ * \param period_ms
+ *        how often the loop runs
+ * \param deadline_us
+ *        longest a run may take, 0 for the whole period
+ */
+int add(const std::string& name, uint32_t period_ms, uint32_t deadline_us = 0);
+
+/**
+ * Watches a task that can't be instrumented.  Only its state and stack are reported.
+ *
+ * \param task_name
+ *        name the task was created with
+ */
+void watch(const char* task_name);
+
+/**
+ * Watches a task that can't be instrumented.  Only its state and stack are reported.
+ *
+ * \param name
+ *        shown in reports
+ * \param task
+ *        handle, like (pros::task_t)chassis.ez_auto
+ */
+void watch(const std::string& name, pros::task_t task);
+
+/**
+ * Marks the start of a run.
+ */
+void begin(int id);
+
+/**
+ * Marks the end of a run.
+ */
+void end(int id);
+
+/**
+ * Runs an action when a loop is late or overruns several runs in a row.  The action runs in the
+ * loop's own task from end(), once per streak, so keep it short, like stopping the drive.
+ *
+ * \param id
+ *        from add()
+ * \param misses
+ *        runs in a row
+ * \param action
+ *        what to do, given the loop's statistics
+ */
+void watchdog_set(int id, int misses, std::function<void(const job_stats&)> action);
+
+/**
+ * Starts the task that refreshes CPU and stack numbers once a second.
+ */
+void initialize();
+
+/**
+ * Returns every task's statistics.
+ */
+std::vector<job_stats> stats_get();
+
+/**
+ * Prints every task's statistics to the terminal.
+ */
+void print();
+
+/**
+ * Appends every task's statistics to a CSV on the SD card once a second.
+ *
+ * \param path
+ *        file on the SD card
+ */
+void log_start(const std::string& path = "/usd/m13_tasks.csv");
+
+/**
+ * Stops appending to the SD card.
+ */
+void log_stop();
+
+/**
+ * Shows the statistics on the brain screen, within a tenth of a second.  The page is drawn by an
+ * LVGL timer that initialize() starts.
+ */
+void show();
+
+/**
+ * Returns to the screen that was active before show(), on the page's next update.
+ */
+void hide();
+
+}  // namespace monitor
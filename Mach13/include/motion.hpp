@@ -0,0 +1,316 @@
+#pragma once
+
+#include <vector>
+
+#include "EZ-Template/util.hpp"
+#include "api.h"
+#include "geometry/profilepoint.hpp"
+#include "path.hpp"
+
+// Motions EZ-Template doesn't have
+//  These run in their own task and drive the chassis with drive_set(), EZ-Template's own motions are
+//  disabled while one runs.  Wheel speeds are planned in in/s and turned into motor output with a
+//  velocity feedforward (kV, kA) plus a little feedback (kP) on the measured wheel speed.
+namespace motion {
+
+/**
+ * Enum for which motion is running.
+ */
+enum e_motion_mode { IDLE = 0,
+                     ADAPTIVE_PURSUIT = 1,
+                     TRAJECTORY = 2,
+                     CHAIN = 3,
+                     PROFILED_TURN = 4 };
+
+/**
+ * Enum for chained motion steps.
+ */
+enum e_step { STEP_DRIVE = 0,
+              STEP_TURN = 1,
+              STEP_SWING = 2,
+              STEP_POINT = 3 };
+
+/**
+ * Struct for the wheel velocity controller.
+ */
+typedef struct velocity_constants {
+  double kV = 1.66;  // output per in/s, 127 / top wheel speed
+  double kA = 0.0;   // output per in/s^2
+  double kP = 0.5;   // output per in/s of error
+} velocity_constants;
+
+/**
+ * Struct for adaptive pure pursuit.
+ */
+typedef struct pursuit_constraints {
+  path::limits limits;                    // velocity, acceleration and lateral acceleration limits
+  double lookahead_min = 6.0;             // in
+  double lookahead_max = 16.0;            // in
+  double lookahead_speed_gain = 0.15;     // in of lookahead per in/s of speed
+  double lookahead_curvature_gain = 6.0;  // lookahead is divided by 1 + this * |curvature| * lookahead_max
+  double spacing = 1.0;                   // in between injected points
+  double exit_error = 1.0;                // in from the end to finish
+} pursuit_constraints;
+
+/**
+ * Struct for RAMSETE trajectory tracking.
+ */
+typedef struct ramsete_constants {
+  double b = 0.0013;        // 1/in^2, how hard position error is corrected (2 1/m^2)
+  double zeta = 0.7;        // damping, 0 to 1
+  double exit_error = 1.5;  // in from the end to finish once the trajectory's time is up
+  int settle_time = 500;    // ms allowed after the trajectory's time is up
+} ramsete_constants;
+
+/**
+ * Struct for one step of a chained motion, made with drive_step(), turn_step(), swing_step() and point_step().
+ */
+typedef struct step {
+  e_step type;
+  double target;                   // in for drive, degrees for turn and swing
+  ez::pose point;                  // point steps
+  ez::e_swing side;                // swing steps
+  ez::drive_directions direction;  // point steps
+  double max_speed;                // in/s of the fastest wheel
+  bool stop;                       // come to rest at the end of this step
+} step;
+
+/**
+ * Struct for chained motion planning.
+ */
+typedef struct chain_constants {
+  double max_accel = 80.0;       // in/s^2 of wheel speed
+  double max_decel = 60.0;       // in/s^2 of wheel speed
+  double junction_speed = 12.0;  // in/s a wheel's speed may jump by between steps, sharper changes slow down first
+  double heading_kP = 1.0;       // in/s of wheel speed difference per degree, holds heading on drives
+  double settle_kP = 4.0;        // in/s per in, pulls onto the end of steps that stop
+  double exit_error = 0.5;       // in of wheel travel from the end of a step that stops
+} chain_constants;
+
+/**
+ * Returns a step that drives straight.
+ *
+ * \param distance
+ *        in, negative drives backwards
+ * \param max_speed
+ *        in/s
+ * \param stop
+ *        true comes to rest at the end of this step
+ */
+step drive_step(double distance, double max_speed = 60.0, bool stop = false);
+
+/**
+ * Returns a step that turns in place to an absolute heading, the shortest way.
+ *
+ * \param theta
+ *        degrees
+ * \param max_speed
+ *        in/s of wheel speed
+ * \param stop
+ *        true comes to rest at the end of this step
+ */
+step turn_step(double theta, double max_speed = 50.0, bool stop = false);
+
+/**
+ * Returns a step that swings on one side to an absolute heading, the shortest way.
+ *
+ * \param side
+ *        ez::LEFT_SWING moves the left side, ez::RIGHT_SWING moves the right side
+ * \param theta
+ *        degrees
+ * \param max_speed
+ *        in/s of the moving side
+ * \param stop
+ *        true comes to rest at the end of this step
+ */
+step swing_step(ez::e_swing side, double theta, double max_speed = 50.0, bool stop = false);
+
+/**
+ * Returns a step that faces a point and drives to it.
+ *
+ * \param target
+ *        odom coordinates, theta is ignored
+ * \param direction
+ *        fwd or rev
+ * \param max_speed
+ *        in/s
+ * \param stop
+ *        true comes to rest at the end of this step
+ */
+step point_step(ez::pose target, ez::drive_directions direction = ez::fwd, double max_speed = 60.0, bool stop = false);
+
+/**
+ * Struct for profiled turns.  Output is motor power, -127 to 127, on each side.
+ */
+typedef struct turn_constants {
+  double max_rate = 360.0;    // deg/s
+  double max_accel = 1500.0;  // deg/s^2
+  double max_decel = 1200.0;  // deg/s^2
+  double kV = 0.21;           // output per deg/s, 127 / full power turn rate
+  double kA = 0.0;            // output per deg/s^2
+  double kP = 2.0;            // output per degree behind the profile
+  double kD = 0.05;           // output per deg/s of turn rate behind the profile
+  double exit_error = 1.0;    // degrees
+  double exit_rate = 20.0;    // deg/s
+  int settle_time = 400;      // ms allowed after the profile ends
+} turn_constants;
+
+/**
+ * Sets the wheel velocity controller constants.
+ */
+void velocity_constants_set(double kV, double kA, double kP);
+
+/**
+ * Returns the wheel velocity controller constants.
+ */
+velocity_constants velocity_constants_get();
+
+/**
+ * Follows a path with pure pursuit, starting from the current pose.
+ *
+ * The lookahead grows with speed and shrinks in curves, and speed is planned along the whole
+ * path from the curvature and constraints, so the robot carries speed down straights and slows
+ * only as much as each curve needs.
+ *
+ * \param points
+ *        waypoints in odom coordinates, theta is ignored
+ * \param direction
+ *        fwd or rev
+ * \param constraints
+ *        limits and lookahead tuning
+ */
+void pursuit_set(std::vector<ez::pose> points, ez::drive_directions direction = ez::fwd, pursuit_constraints constraints = {});
+
+/**
+ * Follows a path with pure pursuit, starting from the current pose.
+ *
+ * \param points
+ *        waypoints in odom coordinates using okapi units, theta is ignored
+ * \param direction
+ *        fwd or rev
+ * \param constraints
+ *        limits and lookahead tuning
+ */
+void pursuit_set(std::vector<ez::united_pose> points, ez::drive_directions direction = ez::fwd, pursuit_constraints constraints = {});
+
+/**
+ * Tracks a time parameterized trajectory with a RAMSETE controller and wheel velocity feedforward.
+ *
+ * Every point is reached at its planned time, so segment times are the same run to run.
+ * Generate the profile with squiggles in inches and odom coordinates, squiggles' yaw is
+ * 0 along +x and counterclockwise, it's converted to odom's heading here.
+ *
+ * \param profile
+ *        points from squiggles::SplineGenerator::generate()
+ * \param direction
+ *        fwd, or rev to drive the profile backwards
+ * \param constants
+ *        RAMSETE gains and exit conditions
+ */
+void trajectory_set(std::vector<squiggles::ProfilePoint> profile, ez::drive_directions direction = ez::fwd, ramsete_constants constants = {});
+
+/**
+ * Runs steps back to back as one motion.
+ *
+ * One velocity profile is planned across every step, so speed carries from one step into the next.
+ * How fast a boundary is crossed depends on how much each wheel's speed has to change there:
+ * drive into drive keeps full speed, drive into a swing slows a little, drive into a turn in place
+ * nearly stops.  The robot only comes to rest on steps with stop set, and at the end.
+ *
+ * \param steps
+ *        steps in order
+ * \param constants
+ *        planning limits
+ */
+void chain_set(std::vector<step> steps, chain_constants constants = {});
+
+/**
+ * Returns the index of the chained step that's running, -1 if no chain is running.
+ */
+int chain_step_get();
+
+/**
+ * Blocks until a chain reaches a step.
+ *
+ * \param index
+ *        step index
+ */
+void wait_until_step(int index);
+
+/**
+ * Sets the constants used by turn_set().
+ */
+void turn_constants_set(turn_constants constants);
+
+/**
+ * Returns the constants used by turn_set().
+ */
+turn_constants turn_constants_get();
+
+/**
+ * Turns in place along a planned angular velocity profile.
+ *
+ * The profile is fed forward and the loop is closed on both the heading and its turn rate (heading::rate_get()),
+ * so a 15 degree and a 170 degree turn behave the same way instead of sharing one set of PID gains.
+ *
+ * \param theta
+ *        target heading in degrees
+ * \param behavior
+ *        which way to go, ez::shortest, ez::longest, ez::cw, ez::ccw or ez::raw
+ */
+void turn_set(double theta, ez::e_angle_behavior behavior = ez::shortest);
+
+/**
+ * Turns in place along a planned angular velocity profile.
+ *
+ * \param theta
+ *        target heading using okapi units
+ * \param behavior
+ *        which way to go, ez::shortest, ez::longest, ez::cw, ez::ccw or ez::raw
+ */
+void turn_set(okapi::QAngle theta, ez::e_angle_behavior behavior = ez::shortest);
+
+/**
+ * Turns in place relative to the current heading along a planned angular velocity profile.
+ *
+ * \param theta
+ *        degrees, positive is clockwise
+ */
+void turn_relative_set(double theta);
+
+/**
+ * Turns in place relative to the current heading along a planned angular velocity profile.
+ *
+ * \param theta
+ *        angle using okapi units, positive is clockwise
+ */
+void turn_relative_set(okapi::QAngle theta);
+
+/**
+ * Spins the robot at full power for a moment and measures its top turn rate and acceleration.
+ * The results are printed and 80% of them become the turn_set() limits, with kV from the top rate.
+ * Blocks for about a second, run it with the robot on the field with room to spin.
+ */
+void turn_characterize();
+
+/**
+ * Blocks until the current motion finishes.
+ */
+void wait();
+
+/**
+ * Blocks until the robot is within distance of the end of the current motion.
+ */
+void wait_until_remaining(double distance);
+
+/**
+ * Stops the current motion and the drive.
+ */
+void cancel();
+
+/**
+ * Returns the running motion, IDLE if none.
+ */
+e_motion_mode mode_get();
+
+}  // namespace motion
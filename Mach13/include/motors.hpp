@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "api.h"
+
+// Motor command layer
+//  Control loops say what every motor should be doing every tick, mostly the same thing as last
+//  tick.  Commands given here are held until flush(), and only the ones that changed go out, one
+//  call per motor group rather than per motor.  Each output belongs to one task, which flushes it at
+//  the end of its own tick: the drive to whichever task drives (driver.hpp or opcontrol), the lady
+//  brown to its job and the inveyor to opcontrol.  Flushing another task's output would send its
+//  commands on the wrong task's schedule.  Unchanged commands are still resent every so often, so a motor that was unplugged or
+//  moved by something outside this layer picks its command back up.  How many device writes this
+//  saves is counted.
+namespace motors {
+
+const int DRIVE = 0;  // id of the drive, which is always registered
+const int ALL = -1;
+
+/**
+ * Struct for command statistics, over the last full second.
+ */
+typedef struct stats_t {
+  uint32_t commands;    // commands given
+  uint32_t writes;      // device writes sent, a write to a group of n motors counts n
+  uint32_t suppressed;  // commands dropped because the motor was already doing them
+  uint32_t flushes;
+} stats_t;
+
+/**
+ * Registers a motor or motor group, returning its id.  Safe to call from static initializers.
+ *
+ * \param name
+ *        for printing
+ * \param motor
+ *        a pros::Motor or pros::MotorGroup, which has to outlive the program
+ */
+int add(const std::string& name, pros::AbstractMotor& motor);
+
+/**
+ * Holds a voltage command, like pros::Motor::move().
+ *
+ * \param id
+ *        from add()
+ * \param voltage
+ *        -127 to 127
+ */
+void move(int id, int32_t voltage);
+
+/**
+ * Holds a velocity command, like pros::Motor::move_velocity().
+ *
+ * \param id
+ *        from add()
+ * \param velocity
+ *        rpm for the motor's gearset
+ */
+void move_velocity(int id, int32_t velocity);
+
+/**
+ * Holds a brake command, like pros::Motor::brake().
+ *
+ * \param id
+ *        from add()
+ */
+void brake(int id);
+
+/**
+ * Holds a drive command, like chassis.drive_set().  Always sent while an EZ-Template motion
+ * owns the drive, so it still takes over from one.
+ *
+ * \param left
+ *        -127 to 127
+ * \param right
+ *        -127 to 127
+ */
+void drive_set(int left, int right);
+
+/**
+ * Sends an output's held command if it changed, or hasn't been sent in a while.  Call once at the end
+ * of each tick that gave it commands, from the task that owns it.
+ *
+ * \param id
+ *        from add(), or motors::DRIVE
+ */
+void flush(int id);
+
+/**
+ * Forgets what a motor was last sent, so its next command goes out whatever it is.  Call after
+ * anything outside this layer moved the motors, like an auton.
+ *
+ * \param id
+ *        from add(), or motors::ALL for every motor
+ */
+void invalidate(int id = ALL);
+
+/**
+ * Returns command statistics.
+ */
+stats_t stats_get();
+
+/**
+ * Prints command statistics to the terminal.
+ */
+void print();
+
+}  // namespace motors
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Path geometry and velocity profiles
+//  Shared by the robot (motion.hpp) and the host tools, so this only depends on the standard library.
+//  Units are inches and seconds, odom coordinates (theta 0 is +y, clockwise positive).
+namespace path {
+
+/**
+ * Struct for a point on the field.
+ */
+typedef struct point {
+  double x;
+  double y;
+} point;
+
+/**
+ * Struct for a point of a profiled path.
+ */
+typedef struct sample {
+  double x;
+  double y;
+  double distance;   // along the path from the start
+  double curvature;  // 1 / radius, positive curves right
+  double velocity;   // planned speed in in/s
+} sample;
+
+/**
+ * Struct for the limits a path is profiled with.
+ */
+typedef struct limits {
+  double max_velocity = 60.0;       // in/s
+  double max_accel = 80.0;          // in/s^2
+  double max_decel = 60.0;          // in/s^2
+  double max_lateral_accel = 60.0;  // in/s^2, v^2 * curvature is kept under this
+  double start_velocity = 0.0;      // in/s
+  double end_velocity = 0.0;        // in/s
+} limits;
+
+inline double distance(point a, point b) { return std::hypot(b.x - a.x, b.y - a.y); }
+
+/**
+ * Adds points between waypoints so they're at most spacing apart.
+ */
+inline std::vector<point> inject(const std::vector<point>& waypoints, double spacing) {
+  std::vector<point> out;
+  if (waypoints.empty()) return out;
+  for (size_t i = 0; i + 1 < waypoints.size(); i++) {
+    point a = waypoints[i], b = waypoints[i + 1];
+    int steps = std::max(1, (int)std::ceil(distance(a, b) / spacing));
+    for (int n = 0; n < steps; n++) out.push_back({a.x + (b.x - a.x) * n / steps, a.y + (b.y - a.y) * n / steps});
+  }
+  out.push_back(waypoints.back());
+  return out;
+}
+
+/**
+ * Rounds the corners of an injected path, the end points don't move.
+ *
+ * \param weight_data
+ *        how strongly points stay where they were
+ * \param weight_smooth
+ *        how strongly points are pulled toward their neighbors
+ * \param tolerance
+ *        stops once a pass moves the points less than this in total
+ */
+inline std::vector<point> smooth(std::vector<point> in, double weight_data = 0.25, double weight_smooth = 0.75, double tolerance = 0.001) {
+  std::vector<point> out = in;
+  double change = tolerance;
+  for (int pass = 0; pass < 200 && change >= tolerance; pass++) {
+    change = 0.0;
+    for (size_t i = 1; i + 1 < in.size(); i++) {
+      point old = out[i];
+      out[i].x += weight_data * (in[i].x - out[i].x) + weight_smooth * (out[i - 1].x + out[i + 1].x - 2.0 * out[i].x);
+      out[i].y += weight_data * (in[i].y - out[i].y) + weight_smooth * (out[i - 1].y + out[i + 1].y - 2.0 * out[i].y);
+      change += std::fabs(old.x - out[i].x) + std::fabs(old.y - out[i].y);
+    }
+  }
+  return out;
+}
+
+/**
+ * Returns the signed curvature of the circle through three points, positive curves right.
+ */
+inline double curvature(point a, point b, point c) {
+  double cross = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+  double product = distance(a, b) * distance(b, c) * distance(a, c);
+  if (product < 1e-9) return 0.0;
+  return -2.0 * cross / product;
+}
+
+/**
+ * Profiles a path.  Speed is limited by curvature and lateral acceleration at every point,
+ * then accelerates from start_velocity and decelerates into end_velocity.
+ */
+inline std::vector<sample> profile(const std::vector<point>& points, const limits& l) {
+  std::vector<sample> out(points.size());
+  double along = 0.0;
+  for (size_t i = 0; i < points.size(); i++) {
+    if (i > 0) along += distance(points[i - 1], points[i]);
+    double k = (i == 0 || i + 1 == points.size()) ? 0.0 : curvature(points[i - 1], points[i], points[i + 1]);
+    double v = l.max_velocity;
+    if (std::fabs(k) > 1e-6) v = std::min(v, std::sqrt(l.max_lateral_accel / std::fabs(k)));
+    out[i] = {points[i].x, points[i].y, along, k, v};
+  }
+  if (out.empty()) return out;
+
+  out.front().velocity = std::min(out.front().velocity, l.start_velocity);
+  for (size_t i = 1; i < out.size(); i++) {
+    double ds = out[i].distance - out[i - 1].distance;
+    out[i].velocity = std::min(out[i].velocity, std::sqrt(out[i - 1].velocity * out[i - 1].velocity + 2.0 * l.max_accel * ds));
+  }
+  out.back().velocity = std::min(out.back().velocity, l.end_velocity);
+  for (size_t i = out.size() - 1; i > 0; i--) {
+    double ds = out[i].distance - out[i - 1].distance;
+    out[i - 1].velocity = std::min(out[i - 1].velocity, std::sqrt(out[i].velocity * out[i].velocity + 2.0 * l.max_decel * ds));
+  }
+  return out;
+}
+
+/**
+ * Returns the index of the path point closest to p, searching forward from `from` so the robot never
+ * snaps back to an earlier part of a path that crosses itself.
+ */
+inline size_t closest(const std::vector<sample>& path, point p, size_t from, size_t window = 24) {
+  size_t best = from;
+  double best_distance = 1e12;
+  for (size_t i = from; i < path.size() && i < from + window; i++) {
+    double d = distance(p, {path[i].x, path[i].y});
+    if (d < best_distance) {
+      best_distance = d;
+      best = i;
+    }
+  }
+  return best;
+}
+
+/**
+ * Finds where a circle around p leaves the path, searching forward from segment `from`.
+ * progress is segment index + fraction and never goes backwards.  Returns false if the circle
+ * doesn't cross the rest of the path, out is then the last point.
+ */
+inline bool lookahead(const std::vector<sample>& path, point p, double radius, double& progress, point& out) {
+  out = {path.back().x, path.back().y};
+  for (size_t i = (size_t)progress; i + 1 < path.size(); i++) {
+    double dx = path[i + 1].x - path[i].x, dy = path[i + 1].y - path[i].y;
+    double fx = path[i].x - p.x, fy = path[i].y - p.y;
+    double a = dx * dx + dy * dy, b = 2.0 * (fx * dx + fy * dy), c = fx * fx + fy * fy - radius * radius;
+    double discriminant = b * b - 4.0 * a * c;
+    if (a < 1e-12 || discriminant < 0) continue;
+    discriminant = std::sqrt(discriminant);
+    // The far intersection is the one ahead of the robot
+    double t = (-b + discriminant) / (2.0 * a);
+    if (t < 0.0 || t > 1.0) continue;
+    if (i + t < progress) continue;
+    progress = i + t;
+    out = {path[i].x + t * dx, path[i].y + t * dy};
+    return true;
+  }
+  return false;
+}
+
+/**
+ * Returns the curvature of the arc from a robot at pose (x, y, theta in degrees) to target, positive curves right.
+ */
+inline double arc_curvature(point robot, double theta, point target) {
+  double rad = theta * M_PI / 180.0;
+  double dx = target.x - robot.x, dy = target.y - robot.y;
+  double lateral = dx * std::cos(rad) - dy * std::sin(rad);  // right of the robot
+  double d2 = dx * dx + dy * dy;
+  if (d2 < 1e-9) return 0.0;
+  return 2.0 * lateral / d2;
+}
+
+}  // namespace path
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "api.h"
+
+// Sensor hub
+//  Every registered device is read once at the start of a control tick, by update() at the top of
+//  the opcontrol loop, and the values are published together as one read-only frame.  Everything
+//  that tick reads the same frame, so two checks of the same sensor can't disagree and each device
+//  is only asked once.  When no control loop is calling update(), like during autonomous, the
+//  hub's own task keeps the frame fresh.  Values can be smoothed per device, and how long the reads
+//  take is measured.
+namespace sensors {
+
+/**
+ * Struct for one tick's readings.
+ */
+typedef struct frame {
+  uint32_t tick;               // counts up every update
+  uint32_t time;               // ms, when the reads started
+  uint32_t read_us;            // how long the reads took
+  std::vector<double> values;  // by the id add() returned
+} frame;
+
+/**
+ * Struct for hub statistics.
+ */
+typedef struct stats_t {
+  uint32_t ticks;        // updates so far
+  uint32_t task_ticks;   // of those, done by the hub's task
+  uint32_t last_read_us;
+  uint32_t max_read_us;
+  int devices;
+} stats_t;
+
+/**
+ * Registers a device, returning its id in frame.values.  Safe to call from static initializers.
+ *
+ * \param name
+ *        for printing and find()
+ * \param read
+ *        reads the device, called once per tick
+ * \param smoothing
+ *        0 to 1, the share of each new reading kept, 1 is no smoothing
+ */
+int add(const std::string& name, std::function<double()> read, double smoothing = 1.0);
+
+/**
+ * Returns the id of a device, -1 if it isn't registered.
+ */
+int find(const std::string& name);
+
+/**
+ * Sets a device's smoothing.
+ *
+ * \param id
+ *        from add()
+ * \param smoothing
+ *        0 to 1, the share of each new reading kept, 1 is no smoothing
+ */
+void smoothing_set(int id, double smoothing);
+
+/**
+ * Starts the hub's task and takes the first reading.
+ */
+void initialize();
+
+/**
+ * Reads every device and publishes a new frame.  Call once at the top of a control loop.
+ */
+void update();
+
+/**
+ * Returns the latest frame.  Hold onto it for the whole tick so every decision sees the same readings.
+ */
+std::shared_ptr<const frame> get();
+
+/**
+ * Returns one device's latest reading, or reads it directly if the hub hasn't started.
+ */
+double value(int id);
+
+/**
+ * Returns hub statistics.
+ */
+stats_t stats_get();
+
+/**
+ * Prints every device and its latest reading to the terminal.
+ */
+void print();
+
+}  // namespace sensors
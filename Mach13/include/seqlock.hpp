@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Single writer, many reader publication, shared by the robot and the host tools, so this only
+// depends on the standard library.
+//  A sequence counter guards two copies of the value.  The writer bumps the counter, updates the
+//  copy readers aren't being sent to, bumps it again and updates the other.  Readers copy whichever
+//  copy the counter points at and retry only if the counter moved while they copied.  The writer
+//  never waits, and because one copy is always whole, a reader never waits on a writer that was
+//  preempted halfway through, which a plain seqlock would spin on forever with a single core.
+//  T has to be trivially copyable.
+template <typename T>
+class seqlock {
+ public:
+  /**
+   * \param initial
+   *        what get() returns before the first set()
+   */
+  explicit seqlock(const T& initial = T()) {
+    copies[0] = initial;
+    copies[1] = initial;
+  }
+
+  /**
+   * Publishes a new value.  Only one task may ever call this.
+   */
+  void set(const T& value) {
+    uint32_t s = sequence.load(std::memory_order_relaxed);
+    sequence.store(s + 1, std::memory_order_relaxed);  // Odd, readers use copies[1]
+    std::atomic_thread_fence(std::memory_order_release);
+    copies[0] = value;
+    std::atomic_thread_fence(std::memory_order_release);
+    sequence.store(s + 2, std::memory_order_relaxed);  // Even, readers use copies[0]
+    std::atomic_thread_fence(std::memory_order_release);
+    copies[1] = value;
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  /**
+   * Returns the last value published, never torn.
+   */
+  T get() const {
+    T out;
+    uint32_t before, after;
+    do {
+      before = sequence.load(std::memory_order_acquire);
+      out = copies[before & 1];
+      std::atomic_thread_fence(std::memory_order_acquire);
+      after = sequence.load(std::memory_order_relaxed);
+    } while (before != after);
+    return out;
+  }
+
+  /**
+   * Returns how many values have been published.
+   */
+  uint32_t version() const { return sequence.load(std::memory_order_acquire) / 2; }
+
+ private:
+  std::atomic<uint32_t> sequence{0};
+  T copies[2];
+};
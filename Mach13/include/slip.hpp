@@ -0,0 +1,94 @@
+#pragma once
+
+#include <vector>
+
+#include "EZ-Template/util.hpp"
+#include "api.h"
+
+// Wheel slip and collision detection
+//  Every 10ms the motion the drive encoders claim is compared with what the IMU felt.  Wheels that
+//  turn the robot faster than the gyro says, or accelerate harder than the accelerometer says, are
+//  slipping, and odometry only trusts a fraction of the encoder motion until they grip again.
+//  A jolt the wheels didn't cause is an impact.  Events are latched for autons to check, like
+//  chassis.interfered, which is also set on every event.
+namespace slip {
+
+/**
+ * Enum for detected events.
+ */
+enum e_event { NONE = 0,
+               WHEEL_SLIP = 1,  // wheels accelerating harder than the robot
+               SPIN = 2,        // wheels turning the robot faster than the gyro
+               IMPACT = 3,      // the robot was hit, or hit something
+               STALL = 4 };     // pushing against something, high current and no motion
+
+/**
+ * Struct for an event.
+ */
+typedef struct event {
+  e_event type;
+  uint32_t time;     // ms
+  double magnitude;  // in/s^2 for slip and impacts, deg/s for spins, mA for stalls
+  ez::pose pose;     // where it happened
+} event;
+
+/**
+ * Struct for detector thresholds.
+ *
+ * One encoder tick in 10ms is about 2.5 in/s on a 3.25" wheel, so even filtered the encoders'
+ * acceleration moves about 80 in/s^2 on noise alone, and their turn rate about 15 deg/s.
+ */
+typedef struct constants_t {
+  double spin_rate = 60.0;      // deg/s the encoders' turn rate may disagree with the gyro
+  double slip_accel = 160.0;    // in/s^2 the encoders' acceleration may exceed the IMU's
+  double impact_accel = 300.0;  // in/s^2 the IMU may exceed what the encoders explain
+  int stall_current = 2000;     // mA per side
+  double stall_speed = 3.0;     // in/s, just over one encoder tick per loop
+  int confirm_time = 40;        // ms a disagreement has to last, single samples are noise
+  int stall_time = 250;         // ms of stall before it's reported
+  int release_time = 100;       // ms of agreement before slipping ends
+  double odom_weight = 0.25;    // share of encoder motion odometry keeps while slipping
+} constants_t;
+
+/**
+ * Starts the detector task, and the task that takes slipping motion back out of odometry, which
+ * runs just below EZ-Template's task.  Call once the IMU is calibrated.
+ */
+void initialize();
+
+/**
+ * Sets the detector thresholds.
+ */
+void constants_set(constants_t constants);
+
+/**
+ * Returns the detector thresholds.
+ */
+constants_t constants_get();
+
+/**
+ * Returns true while the wheels are slipping or spinning.
+ */
+bool slipping();
+
+/**
+ * Returns true if anything was detected since the last clear().
+ */
+bool interfered();
+
+/**
+ * Forgets past events.
+ */
+void clear();
+
+/**
+ * Returns the newest event, type is NONE if there hasn't been one since clear().
+ */
+event last_event_get();
+
+/**
+ * Returns events since the last clear(), oldest first, up to the last 32.
+ */
+std::vector<event> events_get();
+
+}  // namespace slip
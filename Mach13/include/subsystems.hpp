@@ -1,21 +1,41 @@
 #pragma once
 
 #include "api.h"
+#include "jobs.hpp"
+#include "motors.hpp"
+#include "sensors.hpp"
 
 // Your motors, sensors, etc. should go here.  Below are examples
 
 // Conveyor
     inline pros::Motor inveyor (11, pros::MotorGears::blue , pros::MotorUnits::rotations);
+    inline const int INVEYOR_MOTOR = motors::add("inveyor", inveyor);  // Commands go through motors.hpp
+    inline const int INVEYOR_VELOCITY = sensors::add("inveyor_velocity", [] { return inveyor.get_actual_velocity(); });
+    inline const int INVEYOR_CURRENT = sensors::add("inveyor_current", [] { return (double)inveyor.get_current_draw(); });
 // Ladybrown
-    #define LDB_SPEED 125
-    #define MIN_ANGLE 7
-    #define LOAD_ANGLE 11
-    #define MAX_ANGLE 57
+    // Not constants so tuned values can be loaded from the SD card, see config.hpp
+    inline int LDB_SPEED = 125;
+    inline int MIN_ANGLE = 7;
+    inline int LOAD_ANGLE = 11;
+    inline int MAX_ANGLE = 57;
     inline pros::MotorGroup ladybrown ({16, -15}, pros::MotorGears::green , pros::MotorUnits::degrees);
+    inline const int LDB_MOTOR = motors::add("ladybrown", ladybrown);
     inline pros::ADIPotentiometer ldb ('H', pros::E_ADI_POT_EDR);
-    inline int ladystate = 0; // -1 = Free Spin, 0 = Passthrough, 1 = Load, 2 = Score, 3 = Override
+    // Read once per tick by the sensor hub, see sensors.hpp
+    inline const int LDB_POT = sensors::add("ldb_pot", [] { return (double)ldb.get_value(); });
+    inline const int LDB_POSITION = sensors::add("ladybrown_position", [] { return ladybrown.get_position(); });
+    inline const int LDB_VELOCITY = sensors::add("ladybrown_velocity", [] { return ladybrown.get_actual_velocity(); });
+    inline const int LDB_CURRENT = sensors::add("ladybrown_current", [] { return (double)ladybrown.get_current_draw(); });
+    // Driver input, sent every opcontrol loop.  The Lady Brown job only moves the arm while these keep coming
+    typedef struct ladybrown_input {
+      int manual;  // 1 = Up, -1 = Down, 0 = Neither
+      bool next;   // Step to the next state
+      bool score;  // Hold to keep raising in Score
+    } ladybrown_input;
+    inline jobs::mailbox<ladybrown_input> ladybrown_command;
+    inline jobs::mailbox<int> ladybrown_state (0); // -1 = Free Spin, 0 = Passthrough, 1 = Load, 2 = Score, 3 = Override
     inline int ldb_pct() {
-      return ldb.get_value() / 40.96;
+      return sensors::value(LDB_POT) / 40.96;
     }
 // Ring Rush
     inline pros::adi::Pneumatics rush ('B', false);
@@ -23,23 +43,24 @@
 #pragma region Mogo Clamp
     inline pros::adi::DigitalOut mogo ('A', 0);
     inline pros::adi::DigitalIn btn ('G');
-    inline int clampstate = 0; // 0 = Open, 1 = Armed, 2 = Clamped
+    inline const int CLAMP_BUTTON = sensors::add("clamp_button", [] { return (double)btn.get_value(); });
+    inline jobs::mailbox<int> clamp_command (0);
+    inline jobs::mailbox<int> clamp_state (0); // 0 = Open, 1 = Armed, 2 = Clamped
 
+    // The clamp job moves the piston, and the controller job shows the text and rumbles
     inline void set_clamp(int state) {
-      clampstate = state; // Update the clamp state
-      mogo.set_value(clampstate == 2);
-      pros::delay(50); // Wait for controller screen refresh
-      // Set the screen text and rumble the controller
-      if (clampstate == 0) {
-        master.set_text(0, 0, "Open     ");
-      } else if (clampstate == 1) {
-        master.set_text(0, 0, "Armed     ");
-        pros::delay(50);
-        master.rumble("-");
-      } else if (clampstate == 2) {
-        master.set_text(0, 0, "Clamped");
-        pros::delay(50);
-        master.rumble(".");
-      }
+      clamp_command.send(state);
+    }
+
+    // For autons, which drive off right after.  Waits for the clamp job to fire the piston, then ms more
+    //  for it to close on the goal, about what set_clamp() took before the clamp job did the screen
+    inline void set_clamp_wait(int state, int ms = 100) {
+      uint32_t fired = clamp_state.count();
+      set_clamp(state);
+      for (int waited = 0; clamp_state.count() == fired && waited < 50; waited += 5) pros::delay(5);  // Next clamp tick
+      pros::delay(ms);
     }
 #pragma endregion
+
+// Starts the Lady Brown, clamp and controller jobs, see subsystems.cpp
+void mechanisms_initialize();
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "api.h"
+#include "pros/serial.hpp"
+#include "telemetry_codec.hpp"
+
+// Live telemetry stream
+//  A low priority task samples the subscribed channels and sends them as compact framed packets
+//  (see telemetry_codec.hpp) over a smart port serial adapter or the USB terminal.
+//  Frames that don't fit the bandwidth budget are skipped instead of queued, so the stream
+//  never falls behind and never blocks the task.  tools/telemetry_decode.cpp turns it back into CSV.
+namespace telemetry {
+
+/**
+ * Struct for stream counters.
+ */
+typedef struct stats_t {
+  uint32_t frames_sent;
+  uint32_t frames_skipped;  // over the bandwidth budget or the sink was full
+  uint32_t bytes_sent;
+  uint32_t bytes_per_second;  // measured over the last second
+} stats_t;
+
+/**
+ * Registers the robot's standard channels (pose, PID errors, drive velocity, battery...).
+ * Call before start().
+ */
+void initialize();
+
+/**
+ * Adds or replaces a channel.
+ *
+ * \param id
+ *        0 to CHANNELS_MAX - 1, the decoder's column order
+ * \param name
+ *        column name
+ * \param scale
+ *        resolution, 0.01 keeps two decimal places
+ * \param source
+ *        called from the telemetry task every sample
+ *
+ * A channel that would make the schema frame too big for FRAME_MAX is logged as an error and not added.
+ */
+void channel_add(uint8_t id, std::string name, float scale, std::function<double()> source);
+
+/**
+ * Sets which channels are streamed.
+ *
+ * \param names
+ *        channel names, unknown names are ignored
+ */
+void subscribe(std::vector<std::string> names);
+
+/**
+ * Streams every channel.
+ */
+void subscribe_all();
+
+/**
+ * Sets the bandwidth budget.
+ *
+ * \param bytes_per_second
+ *        average limit, short bursts up to a fifth of this are allowed.  A single frame bigger
+ *        than that still goes out once the burst allowance is full, and later frames pay it back
+ */
+void budget_set(uint32_t bytes_per_second);
+
+/**
+ * Starts streaming.
+ *
+ * \param port
+ *        smart port with a serial adapter, 0 streams over the USB terminal instead
+ * \param baud
+ *        serial baud rate, ignored for the USB terminal
+ * \param period_ms
+ *        time between samples
+ */
+void start(int port = 0, int baud = 115200, uint32_t period_ms = 10);
+
+/**
+ * Sends the schema and a keyframe on the next sample, for when a reader connects mid-stream.
+ */
+void resync();
+
+/**
+ * Returns the stream counters.
+ */
+stats_t stats_get();
+
+}  // namespace telemetry
@@ -0,0 +1,467 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "crc.hpp"
+
+// Telemetry wire format, shared by the robot (telemetry.hpp) and the host decoder (tools/telemetry_decode.cpp)
+//
+//  Every frame is [type][seq][payload][crc16 hi][crc16 lo], COBS encoded and ended with a 0x00 byte,
+//  so a reader that starts mid-stream or loses bytes resyncs at the next 0x00.
+//
+//  'S' schema    count, then per channel: id, scale (float, little endian), name length, name
+//  'K' keyframe  time in ms, channel mask, then per channel in the mask: value / scale as a zigzag varint
+//  'D' delta     ms since the last frame, channel mask, then per channel: change since the last frame
+//
+//  Values are sent as fixed point integers (value / scale), and delta frames only carry the change,
+//  so a channel that barely moves costs one byte.  A reader that misses a frame ignores deltas until
+//  the next keyframe.
+namespace telemetry {
+
+const int CHANNELS_MAX = 32;
+const int NAME_LENGTH_MAX = 15;
+const size_t FRAME_MAX = 320;
+const size_t ENCODED_MAX = FRAME_MAX + FRAME_MAX / 254 + 2;
+
+enum frame_type : uint8_t { FRAME_SCHEMA = 'S',
+                            FRAME_KEY = 'K',
+                            FRAME_DELTA = 'D' };
+
+/**
+ * Struct for a channel definition.
+ */
+typedef struct channel_info {
+  bool defined = false;
+  float scale = 1.0f;
+  char name[NAME_LENGTH_MAX + 1] = "";
+} channel_info;
+
+/**
+ * COBS encodes a buffer.  out needs room for length + length / 254 + 1 bytes, the 0x00 delimiter isn't added.
+ *
+ * Returns the encoded length.
+ */
+inline size_t cobs_encode(const uint8_t* in, size_t length, uint8_t* out) {
+  size_t code_index = 0, write = 1;
+  uint8_t code = 1;
+  for (size_t i = 0; i < length; i++) {
+    if (in[i] == 0) {
+      out[code_index] = code;
+      code_index = write++;
+      code = 1;
+      continue;
+    }
+    out[write++] = in[i];
+    if (++code == 0xFF) {
+      out[code_index] = code;
+      code_index = write++;
+      code = 1;
+    }
+  }
+  out[code_index] = code;
+  return write;
+}
+
+/**
+ * Decodes a COBS frame without its 0x00 delimiter.  out needs room for length bytes.
+ *
+ * Returns the decoded length, or 0 if the frame is malformed.
+ */
+inline size_t cobs_decode(const uint8_t* in, size_t length, uint8_t* out) {
+  size_t read = 0, write = 0;
+  while (read < length) {
+    uint8_t code = in[read++];
+    if (code == 0 || read + code - 1 > length) return 0;
+    for (uint8_t i = 1; i < code; i++) out[write++] = in[read++];
+    if (code != 0xFF && read < length) out[write++] = 0;
+  }
+  return write;
+}
+
+/**
+ * Bounded writer for building frames.
+ */
+class frame_writer {
+ public:
+  frame_writer(uint8_t* buffer, size_t capacity) : buf(buffer), cap(capacity) {}
+
+  void u8(uint8_t value) {
+    if (len < cap)
+      buf[len++] = value;
+    else
+      ok = false;
+  }
+
+  void varint(uint32_t value) {
+    while (value >= 0x80) {
+      u8((uint8_t)(value | 0x80));
+      value >>= 7;
+    }
+    u8((uint8_t)value);
+  }
+
+  // Zigzag so small negative numbers stay small
+  void svarint(int32_t value) { varint(((uint32_t)value << 1) ^ (uint32_t)(value >> 31)); }
+
+  void f32(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 4; i++) u8((uint8_t)(bits >> (8 * i)));
+  }
+
+  uint8_t* buf;
+  size_t cap;
+  size_t len = 0;
+  bool ok = true;
+};
+
+/**
+ * Bounded reader for parsing frames.
+ */
+class frame_reader {
+ public:
+  frame_reader(const uint8_t* buffer, size_t length) : buf(buffer), len(length) {}
+
+  uint8_t u8() {
+    if (pos < len) return buf[pos++];
+    ok = false;
+    return 0;
+  }
+
+  uint32_t varint() {
+    uint32_t value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+      uint8_t byte = u8();
+      value |= (uint32_t)(byte & 0x7F) << shift;
+      if (!(byte & 0x80)) return value;
+    }
+    ok = false;
+    return 0;
+  }
+
+  int32_t svarint() {
+    uint32_t value = varint();
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+  }
+
+  float f32() {
+    uint32_t bits = 0;
+    for (int i = 0; i < 4; i++) bits |= (uint32_t)u8() << (8 * i);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  const uint8_t* buf;
+  size_t len;
+  size_t pos = 0;
+  bool ok = true;
+};
+
+/**
+ * Finishes a raw frame (adds the CRC), COBS encodes it and adds the delimiter.  Returns bytes written to out.
+ */
+inline size_t frame_finish(frame_writer& frame, uint8_t* out) {
+  uint16_t crc = crc::crc16(frame.buf, frame.len);
+  frame.u8((uint8_t)(crc >> 8));
+  frame.u8((uint8_t)crc);
+  if (!frame.ok) return 0;
+  size_t length = cobs_encode(frame.buf, frame.len, out);
+  out[length++] = 0x00;
+  return length;
+}
+
+/**
+ * Builds frames from channel values.
+ *
+ * encode() only builds a frame.  Call commit() once it's actually been sent, so deltas are always
+ * taken against what the reader has seen, and a frame skipped for bandwidth costs nothing.
+ */
+class encoder {
+ public:
+  /**
+   * Defines a channel.
+   *
+   * \param id
+   *        0 to CHANNELS_MAX - 1
+   * \param name
+   *        shown by the decoder, cut to NAME_LENGTH_MAX characters
+   * \param scale
+   *        resolution of the channel, values are sent as round(value / scale)
+   *
+   * Returns false, and leaves the channel list alone, if the id or scale is invalid or the schema
+   * frame would no longer fit in FRAME_MAX.
+   */
+  bool channel_set(uint8_t id, const char* name, float scale) {
+    if (id >= CHANNELS_MAX || scale <= 0.0f) return false;
+    channel_info old = channels[id];
+    channels[id].defined = true;
+    channels[id].scale = scale;
+    strncpy(channels[id].name, name, NAME_LENGTH_MAX);
+    channels[id].name[NAME_LENGTH_MAX] = '\0';
+    if (schema_size() > FRAME_MAX) {
+      channels[id] = old;
+      return false;
+    }
+    schema_due = true;
+    return true;
+  }
+
+  /**
+   * Sets which channels are sent, bit n is channel n.
+   */
+  void subscribe(uint32_t mask) {
+    if (mask != subscribed) key_due = true;
+    subscribed = mask;
+  }
+
+  uint32_t subscribed_get() const { return subscribed; }
+
+  /**
+   * Builds the next frame(s) for this sample into out, which needs room for 2 * ENCODED_MAX bytes.
+   * A schema frame is put in front when one is due.  Returns the number of bytes, 0 if either
+   * frame didn't fit, so commit() is never called for a schema the reader didn't get.
+   *
+   * \param time_ms
+   *        sample time
+   * \param values
+   *        value of every channel, indexed by id
+   */
+  size_t encode(uint32_t time_ms, const double* values, uint8_t* out) {
+    size_t length = 0;
+    pending_schema = schema_due || (key_due && keys_since_schema >= SCHEMA_EVERY) || frames_since_key >= KEY_EVERY * SCHEMA_EVERY;
+    if (pending_schema) {
+      length = schema_build(out);
+      if (length == 0) return 0;
+    }
+
+    pending_key = pending_schema || key_due || frames_since_key >= KEY_EVERY;
+    uint8_t raw[FRAME_MAX];
+    frame_writer frame(raw, sizeof(raw));
+    frame.u8(pending_key ? FRAME_KEY : FRAME_DELTA);
+    frame.u8(pending_schema ? (uint8_t)(seq + 1) : seq);  // The schema frame in front used seq
+    frame.varint(pending_key ? time_ms : time_ms - last_time);
+    frame.varint(subscribed);
+    for (int id = 0; id < CHANNELS_MAX; id++) {
+      if (!(subscribed & (1u << id)) || !channels[id].defined) continue;
+      double q = std::round(values[id] / channels[id].scale);
+      pending[id] = (int32_t)std::fmax(std::fmin(q, (double)INT32_MAX / 2), (double)INT32_MIN / 2);
+      frame.svarint(pending_key ? pending[id] : pending[id] - last[id]);
+    }
+    pending_time = time_ms;
+    size_t written = frame_finish(frame, out + length);
+    return written == 0 ? 0 : length + written;
+  }
+
+  /**
+   * Marks the last encode() as sent.
+   */
+  void commit() {
+    memcpy(last, pending, sizeof(last));
+    last_time = pending_time;
+    seq++;
+    if (pending_schema) {
+      seq++;
+      schema_due = false;
+      keys_since_schema = 0;
+    }
+    if (pending_key) {
+      key_due = false;
+      frames_since_key = 0;
+      keys_since_schema++;
+    } else {
+      frames_since_key++;
+    }
+  }
+
+  /**
+   * Forces the next frame to be a schema and keyframe, used when a reader connects.
+   */
+  void resync() { schema_due = key_due = true; }
+
+  channel_info channels[CHANNELS_MAX];
+
+ private:
+  static const int KEY_EVERY = 25;
+  static const int SCHEMA_EVERY = 8;
+
+  // Raw size of the schema frame, with its CRC
+  size_t schema_size() const {
+    size_t size = 3 + 2;
+    for (auto& channel : channels) {
+      if (channel.defined) size += 6 + strlen(channel.name);
+    }
+    return size;
+  }
+
+  size_t schema_build(uint8_t* out) {
+    uint8_t raw[FRAME_MAX];
+    frame_writer frame(raw, sizeof(raw));
+    frame.u8(FRAME_SCHEMA);
+    frame.u8(seq);
+    uint8_t count = 0;
+    for (auto& channel : channels) count += channel.defined;
+    frame.u8(count);
+    for (int id = 0; id < CHANNELS_MAX; id++) {
+      if (!channels[id].defined) continue;
+      frame.u8((uint8_t)id);
+      frame.f32(channels[id].scale);
+      uint8_t name_length = (uint8_t)strlen(channels[id].name);
+      frame.u8(name_length);
+      for (int i = 0; i < name_length; i++) frame.u8((uint8_t)channels[id].name[i]);
+    }
+    return frame_finish(frame, out);
+  }
+
+  uint32_t subscribed = 0;
+  int32_t last[CHANNELS_MAX] = {};
+  int32_t pending[CHANNELS_MAX] = {};
+  uint32_t last_time = 0, pending_time = 0;
+  uint8_t seq = 0;
+  bool schema_due = true, key_due = true;
+  bool pending_schema = false, pending_key = false;
+  int frames_since_key = 0, keys_since_schema = 0;
+};
+
+/**
+ * Rebuilds channel values from a byte stream.
+ */
+class decoder {
+ public:
+  /**
+   * Struct for decode counters.
+   */
+  typedef struct stats_t {
+    uint32_t frames = 0;       // good frames of any type
+    uint32_t bad_frames = 0;   // COBS or CRC failures
+    uint32_t gaps = 0;         // missing sequence numbers
+    uint32_t unsynced = 0;     // data frames skipped while waiting for a keyframe or schema
+  } stats_t;
+
+  /**
+   * Feeds bytes from the stream.  on_sample(time_ms, mask, values) is called for every decoded
+   * data frame, values is indexed by channel id and only ids in mask are valid.
+   */
+  template <typename F>
+  void feed(const uint8_t* data, size_t length, F&& on_sample) {
+    for (size_t i = 0; i < length; i++) {
+      if (data[i] != 0x00) {
+        if (pending_length < sizeof(pending))
+          pending[pending_length++] = data[i];
+        else
+          overflow = true;
+        continue;
+      }
+      if (pending_length > 0 && !overflow) frame_handle(on_sample);
+      else if (overflow) stats.bad_frames++;
+      pending_length = 0;
+      overflow = false;
+    }
+  }
+
+  channel_info channels[CHANNELS_MAX];
+  stats_t stats;
+
+  /**
+   * Bumped every time a schema frame changes the channel list.
+   */
+  uint32_t schema_version = 0;
+
+ private:
+  template <typename F>
+  void frame_handle(F&& on_sample) {
+    uint8_t raw[ENCODED_MAX];  // Decoding never makes a frame longer
+    if (pending_length > ENCODED_MAX) {
+      stats.bad_frames++;
+      return;
+    }
+    size_t length = cobs_decode(pending, pending_length, raw);
+    if (length < 4 || crc::crc16(raw, length - 2) != (uint16_t)((raw[length - 2] << 8) | raw[length - 1])) {
+      stats.bad_frames++;
+      return;
+    }
+
+    frame_reader frame(raw, length - 2);
+    uint8_t type = frame.u8();
+    uint8_t seq = frame.u8();
+    if (has_seq && seq != (uint8_t)(last_seq + 1)) {
+      stats.gaps++;
+      synced = false;
+    }
+    has_seq = true;
+    last_seq = seq;
+    stats.frames++;
+
+    if (type == FRAME_SCHEMA) {
+      schema_parse(frame);
+      return;
+    }
+    if ((type != FRAME_KEY && type != FRAME_DELTA) || (type == FRAME_DELTA && !synced) || !has_schema) {
+      stats.unsynced++;
+      return;
+    }
+
+    uint32_t time = frame.varint();
+    uint32_t mask = frame.varint();
+    int32_t next[CHANNELS_MAX];
+    memcpy(next, last, sizeof(next));
+    for (int id = 0; id < CHANNELS_MAX; id++) {
+      if (!(mask & (1u << id)) || !channels[id].defined) continue;
+      next[id] = type == FRAME_KEY ? frame.svarint() : last[id] + frame.svarint();
+    }
+    if (!frame.ok) {
+      stats.bad_frames++;
+      synced = false;
+      return;
+    }
+
+    memcpy(last, next, sizeof(last));
+    last_time = type == FRAME_KEY ? time : last_time + time;
+    synced = true;
+
+    double values[CHANNELS_MAX] = {};
+    for (int id = 0; id < CHANNELS_MAX; id++) values[id] = last[id] * (double)channels[id].scale;
+    on_sample(last_time, mask, (const double*)values);
+  }
+
+  void schema_parse(frame_reader& frame) {
+    channel_info parsed[CHANNELS_MAX];
+    uint8_t count = frame.u8();
+    for (int n = 0; n < count && frame.ok; n++) {
+      uint8_t id = frame.u8();
+      float scale = frame.f32();
+      uint8_t name_length = frame.u8();
+      char name[NAME_LENGTH_MAX + 1] = "";
+      for (int i = 0; i < name_length; i++) {
+        char c = (char)frame.u8();
+        if (i < NAME_LENGTH_MAX) name[i] = c;
+      }
+      if (id >= CHANNELS_MAX || scale <= 0.0f) continue;
+      parsed[id].defined = true;
+      parsed[id].scale = scale;
+      memcpy(parsed[id].name, name, sizeof(name));
+    }
+    if (!frame.ok) {
+      stats.bad_frames++;
+      return;
+    }
+    if (memcmp(parsed, channels, sizeof(parsed)) != 0) {
+      memcpy(channels, parsed, sizeof(parsed));
+      schema_version++;
+      synced = false;
+    }
+    has_schema = true;
+  }
+
+  uint8_t pending[ENCODED_MAX + 1];
+  size_t pending_length = 0;
+  bool overflow = false;
+  int32_t last[CHANNELS_MAX] = {};
+  uint32_t last_time = 0;
+  uint8_t last_seq = 0;
+  bool has_seq = false, has_schema = false, synced = false;
+};
+
+}  // namespace telemetry
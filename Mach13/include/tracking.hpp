@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+
+#include "EZ-Template/util.hpp"
+#include "api.h"
+
+// Pose publication
+//  EZ-Template's odometry task writes x, y and theta one at a time, so a task reading them while it
+//  runs can see half an update.  A task just below EZ-Template's priority copies the pose once per
+//  tick, when EZ-Template can't be partway through an update, and publishes it with a timestamp and
+//  velocities through a seqlock (seqlock.hpp).  Any task can then read a whole snapshot without
+//  blocking, or ever being blocked by, the publisher.
+//  The price is up to one tick of lag: a task above EZ-Template's, like the motion controllers, runs
+//  before the publisher each tick, so it sees the pose from the tick before, about 10ms old.  Use
+//  state_t::time, or chassis.odom_pose_get() from a task below EZ-Template's, when that matters.
+namespace tracking {
+
+/**
+ * Struct for a published snapshot.
+ */
+typedef struct state_t {
+  ez::pose pose;      // inches and degrees, odometry's frame
+  double velocity;    // in/s along the robot's heading, backwards is negative
+  double turn_rate;   // deg/s, clockwise positive
+  uint32_t time;      // ms, when the pose was copied
+  uint32_t version;   // counts up every publish
+} state_t;
+
+/**
+ * Starts the publisher.  Call once odometry is running.
+ */
+void initialize();
+
+/**
+ * Returns the latest snapshot.  Reads odometry directly before initialize().
+ */
+state_t get();
+
+/**
+ * Returns the latest pose.
+ */
+ez::pose pose_get();
+
+}  // namespace tracking
@@ -0,0 +1,155 @@
+#include "arm.hpp"
+
+#include "main.h"
+#include "okapi/api/filter/emaFilter.hpp"
+#include "okapi/api/filter/medianFilter.hpp"
+
+namespace arm {
+namespace {
+const int DELAY = ez::util::DELAY_TIME;
+const double DT = DELAY / 1000.0;
+const double POT_RANGE = 250.0;           // degrees across the EDR pot's 0 to 4095
+const double STILL_SPEED = 5.0;           // deg/s of the motors that counts as stopped
+const int STILL_TIME = 100;               // ms stopped before the sensors are compared
+const double SPAN_MIN = 30.0;             // motor degrees between stops for a move to teach the ratio
+const double CALIBRATE_MOTION = 90.0;     // motor degrees of moves before the ratio is trusted
+const double OFFSET_GAIN_STILL = 0.05;    // per loop, how hard the encoders are pulled toward the pot
+const double OFFSET_GAIN_MOVING = 0.005;  // weaker while moving, the median filter lags
+const double POT_BAD = 15.0;              // degrees of disagreement before the pot is ignored
+const double POT_GOOD = 5.0;              // degrees of agreement before it's trusted again
+const double ENCODER_JUMP = 2000.0;       // motor degrees in one loop, more means they were reset
+
+pros::Mutex mutex;
+pros::Task* task = nullptr;
+okapi::MedianFilter<5> pot_filter;
+okapi::EmaFilter velocity_filter(0.3);
+
+status_t state = {0, 0, 0, 0, false, true};
+double offset = 0.0;
+double last_motor = 0.0, last_pot = 0.0;
+double sum_mp = 0.0, sum_mm = 0.0;  // motor * pot and motor * motor over finished moves
+double anchor_motor = 0.0, anchor_pot = 0.0;
+bool anchored = false;
+int still_ms = 0, disagree_ms = 0;
+
+double pot_degrees(double raw) { return raw * POT_RANGE / 4095.0; }
+
+void task_loop() {
+  uint32_t now = pros::millis();
+  int job = monitor::add("Lady Brown", DELAY);
+  while (true) {
+    monitor::begin(job);
+    std::shared_ptr<const sensors::frame> f = sensors::get();
+    double pot = pot_filter.filter(pot_degrees(f->values[LDB_POT]));
+    double motor = f->values[LDB_POSITION];
+    double motor_rate = f->values[LDB_VELOCITY] * 6.0;  // rpm to deg/s
+
+    mutex.take();
+    if (fabs(motor - last_motor) > ENCODER_JUMP) {
+      // Encoders were reset, keep the angle and move the offset
+      offset = state.angle - state.ratio * motor;
+      anchored = false;
+    }
+
+    // Between two stops, the motors and the pot both moved the whole way, lag and noise cancel out
+    still_ms = fabs(motor_rate) < STILL_SPEED ? still_ms + DELAY : 0;
+    if (still_ms == STILL_TIME) {
+      double span_motor = motor - anchor_motor, span_pot = pot - anchor_pot;
+      if (anchored && fabs(span_motor) > SPAN_MIN && state.pot_ok) {
+        sum_mp += span_motor * span_pot;
+        sum_mm += span_motor * span_motor;
+        double ratio = sum_mp / sum_mm;
+        if (state.calibrated) {
+          offset += (state.ratio - ratio) * motor;  // Keep the angle where it was
+        } else if (sum_mm > CALIBRATE_MOTION * CALIBRATE_MOTION) {
+          state.calibrated = true;
+          offset = pot - ratio * motor;
+          LOGI("Lady Brown: %.4f arm degrees per motor degree", ratio);
+        }
+        state.ratio = ratio;
+      }
+      anchor_motor = motor;
+      anchor_pot = pot;
+      anchored = true;
+    }
+
+    if (state.calibrated) {
+      double encoders = state.ratio * motor + offset;
+      double error = pot - encoders;
+      if (state.pot_ok) {
+        disagree_ms = fabs(error) > POT_BAD ? disagree_ms + DELAY : 0;
+        if (disagree_ms >= 250) {
+          state.pot_ok = false;
+          LOGW("Lady Brown: pot disagrees by %.1f degrees, following the encoders", error);
+        }
+      } else {
+        disagree_ms = fabs(error) < POT_GOOD ? disagree_ms + DELAY : 0;
+        if (disagree_ms >= 500) {
+          state.pot_ok = true;
+          disagree_ms = 0;
+        }
+      }
+      if (state.pot_ok) offset += (still_ms >= STILL_TIME ? OFFSET_GAIN_STILL : OFFSET_GAIN_MOVING) * error;
+      state.angle = state.ratio * motor + offset;
+      state.velocity = velocity_filter.filter(state.ratio * motor_rate);
+    } else {
+      // Pot alone until the ratio is known
+      state.angle = pot;
+      state.velocity = velocity_filter.filter((pot - last_pot) / DT);
+    }
+    state.pot = pot;
+    last_motor = motor;
+    last_pot = pot;
+    mutex.give();
+
+    monitor::end(job);
+    pros::Task::delay_until(&now, DELAY);
+  }
+}
+}  // namespace
+
+void initialize() {
+  if (task != nullptr) return;
+  double pot = pot_degrees(sensors::value(LDB_POT));
+  for (int i = 0; i < 5; i++) pot_filter.filter(pot);  // Fill the window, it starts at 0
+  state.angle = state.pot = last_pot = pot;
+  last_motor = sensors::value(LDB_POSITION);
+  task = new pros::Task(task_loop, jobs::priority(DELAY, jobs::ESTIMATION), TASK_STACK_DEPTH_DEFAULT, "Lady Brown");
+}
+
+double angle_get() {
+  mutex.take();
+  double copy = state.angle;
+  mutex.give();
+  return copy;
+}
+
+double velocity_get() {
+  mutex.take();
+  double copy = state.velocity;
+  mutex.give();
+  return copy;
+}
+
+double pct_get() {
+  if (task == nullptr) return sensors::value(LDB_POT) / 40.96;
+  return angle_get() * 4095.0 / (POT_RANGE * 40.96);
+}
+
+status_t status_get() {
+  mutex.take();
+  status_t copy = state;
+  mutex.give();
+  return copy;
+}
+
+void recalibrate() {
+  mutex.take();
+  sum_mp = sum_mm = 0.0;
+  state.calibrated = false;
+  state.ratio = 0.0;
+  anchored = false;
+  mutex.give();
+}
+
+}  // namespace arm
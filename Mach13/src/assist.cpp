@@ -0,0 +1,214 @@
+#include "assist.hpp"
+
+#include "main.h"
+
+namespace assist {
+namespace {
+limits free_limits = {800, 800, 1000, 1200};
+limits clamped_limits = {450, 500, 600, 700};
+double tilt_start = 6.0, tilt_max = 15.0, tilt_min_scale = 0.2;
+curvature_t tuning = {1.0, 4.0, 2.0, 0.5, 0.15, 450.0, 0.001};
+const double QUICK_STOP_DECAY = 100.0;  // per second, how fast the quick stop brake wears off
+const double FEEDBACK_MAX = 0.2;        // most the turn rate feedback can add, out of 1
+
+double forward = 0.0, turn = 0.0;
+double level_pitch = 0.0, level_roll = 0.0;
+bool leveled = false;
+uint32_t last_time = 0;
+
+double last_wheel = 0.0, inertia = 0.0, quick_stop = 0.0;
+bool imu_ready = false;
+
+double curve_left[128], curve_right[128];  // EZ-Template's curves at every stick value
+double curve_probe[2] = {NAN, NAN};        // what the curves gave at 100 when the tables were built
+bool curves_built = false;
+
+uint32_t read_us = 0;  // when this loop's sticks were read
+int last_sticks[2] = {0, 0};
+bool sticks_changed = false;
+
+// Moves current toward target, speeding up and slowing down at their own rates and never skipping past zero
+double forward_limit(double current, double target, const limits& l, double scale, double dt) {
+  double rate;
+  if ((current > 0.0 && target < current) || (current < 0.0 && target > current))
+    rate = l.decel;
+  else
+    rate = target > current ? l.forward_accel : l.reverse_accel;
+  double step = rate * scale * dt;
+  double next = current + std::clamp(target - current, -step, step);
+  if ((current > 0.0 && next < 0.0) || (current < 0.0 && next > 0.0)) next = 0.0;  // Reverse from a stop on the next loop
+  return next;
+}
+
+int stick(pros::controller_analog_e_t channel, bool fresh) {
+  int value = fresh ? std::clamp(master.get_analog(channel), -127, 127) : input::analog(channel);
+  return abs(value) < chassis.opcontrol_joystick_threshold_get() ? 0 : value;
+}
+
+// Rebuilds the curve tables if the curves changed, the curves are worked out with exponentials
+void curves_update() {
+  double probe[2] = {chassis.opcontrol_curve_left(100), chassis.opcontrol_curve_right(100)};
+  curves_built = true;
+  if (probe[0] == curve_probe[0] && probe[1] == curve_probe[1]) return;
+  for (int i = 0; i < 128; i++) {
+    curve_left[i] = chassis.opcontrol_curve_left(i);
+    curve_right[i] = chassis.opcontrol_curve_right(i);
+  }
+  curve_probe[0] = probe[0];
+  curve_probe[1] = probe[1];
+}
+
+// The curves are symmetric about 0
+double curved(const double* table, int value) { return value < 0 ? -table[-value] : table[value]; }
+
+// Seconds since the last call
+double tick() {
+  if (!leveled) reset();
+  uint32_t now = pros::millis();
+  double dt = std::clamp((now - last_time) / 1000.0, 0.0, 0.05);
+  last_time = now;
+  return dt;
+}
+
+// Same sticks and curves as chassis.opcontrol_arcade_standard(), out of 127
+void sticks(ez::e_type stick_type, bool fresh, double& forward_target, double& turn_target) {
+  // Curves only change from curves_iterate(), or from code before reset()
+  if (!curves_built) curves_update();
+
+  read_us = fresh ? pros::micros() : input::get().time_us;
+  int forward_stick = stick(pros::E_CONTROLLER_ANALOG_LEFT_Y, fresh);
+  int turn_stick = stick(stick_type == ez::SPLIT ? pros::E_CONTROLLER_ANALOG_RIGHT_X : pros::E_CONTROLLER_ANALOG_LEFT_X, fresh);
+  sticks_changed = forward_stick != last_sticks[0] || turn_stick != last_sticks[1];
+  last_sticks[0] = forward_stick;
+  last_sticks[1] = turn_stick;
+
+  forward_target = curved(curve_left, forward_stick);
+  turn_target = curved(curve_right, turn_stick);
+  double speed_max = chassis.opcontrol_speed_max_get();
+  forward_target = std::clamp(forward_target, -speed_max, speed_max);
+  turn_target = std::clamp(turn_target, -speed_max, speed_max);
+}
+
+// Moves forward and turn toward their targets through the limits
+void limit(double forward_target, double turn_target, double dt) {
+  if (input::action("assist_bypass")) {
+    forward = forward_target;
+    turn = turn_target;
+    return;
+  }
+  const limits& l = clamp_state.latest() == 2 ? clamped_limits : free_limits;
+  double tilt = std::max(fabs(chassis.imu.get_pitch() - level_pitch), fabs(chassis.imu.get_roll() - level_roll));
+  double scale = 1.0;
+  if (std::isfinite(tilt) && tilt > tilt_start) scale = std::max(tilt_min_scale, 1.0 - (1.0 - tilt_min_scale) * (tilt - tilt_start) / (tilt_max - tilt_start));
+
+  forward = forward_limit(forward, forward_target, l, scale, dt);
+  double turn_step = l.turn_accel * scale * dt;
+  turn += std::clamp(turn_target - turn, -turn_step, turn_step);
+}
+}  // namespace
+
+void limits_set(limits free, limits clamped) {
+  free_limits = free;
+  clamped_limits = clamped;
+}
+
+void tilt_set(double start_angle, double max_angle, double min_scale) {
+  tilt_start = start_angle;
+  tilt_max = max_angle;
+  tilt_min_scale = min_scale;
+}
+
+void bypass_button_set(pros::controller_digital_e_t button) { input::bind("assist_bypass", input::mask({button}), input::HELD); }
+
+void reset() {
+  forward = turn = 0.0;
+  last_wheel = inertia = quick_stop = 0.0;
+  curves_built = false;  // Pick up curves set since the last reset
+  level_pitch = chassis.imu.get_pitch();
+  level_roll = chassis.imu.get_roll();
+  leveled = std::isfinite(level_pitch) && std::isfinite(level_roll);
+  last_time = pros::millis();
+}
+
+void curves_iterate() {
+  const double STEP = 0.1;  // EZ-Template's step
+  double change[2] = {(input::action("curve_left_up") ? STEP : 0.0) - (input::action("curve_left_down") ? STEP : 0.0),
+                      (input::action("curve_right_up") ? STEP : 0.0) - (input::action("curve_right_down") ? STEP : 0.0)};
+  if (change[0] == 0.0 && change[1] == 0.0) return;
+  std::vector<double> curves = chassis.opcontrol_curve_default_get();
+  double left = std::max(0.0, curves[0] + change[0]), right = std::max(0.0, curves[1] + change[1]);
+  chassis.opcontrol_curve_default_set(left, right);
+  curves_built = false;
+  config::save_async();  // The curves are kept with the tuned constants
+  LOGI("Assist: curves %.1f left, %.1f right", left, right);
+}
+
+void curvature_set(curvature_t t) { tuning = t; }
+
+void quick_turn_button_set(pros::controller_digital_e_t button) { input::bind("quick_turn", input::mask({button}), input::HELD); }
+
+void arcade(ez::e_type stick_type, bool fresh) {
+  double dt = tick();
+  double forward_target, turn_target;
+  sticks(stick_type, fresh, forward_target, turn_target);
+  limit(forward_target, turn_target, dt);
+  motors::drive_set(forward + turn, forward - turn);
+  motors::flush(motors::DRIVE);
+  driver::record(read_us, sticks_changed);
+}
+
+void curvature(ez::e_type stick_type, bool fresh) {
+  // EZ-Template's own curve buttons include Y, holding it to quick turn would ramp the curve and save it
+  if (chassis.opcontrol_curve_buttons_toggle_get()) {
+    chassis.opcontrol_curve_buttons_toggle(false);
+    LOGW("Assist: EZ-Template's curve buttons turned off for curvature drive");
+  }
+  double dt = tick();
+  double forward_target, turn_target;
+  sticks(stick_type, fresh, forward_target, turn_target);
+  double throttle = forward_target / 127.0;
+  double wheel = turn_target / 127.0;
+
+  // Negative inertia, a kick in the direction the turn stick is moving that wears off
+  inertia += (wheel - last_wheel) * tuning.negative_inertia;
+  last_wheel = wheel;
+  double decay = tuning.inertia_decay * dt;
+  inertia -= std::clamp(inertia, -decay, decay);
+  wheel += inertia;
+
+  double angular;
+  bool quick_turn = input::action("quick_turn") && !chassis.pid_tuner_enabled();  // The PID tuner uses Y and A
+  if (quick_turn || fabs(throttle) < tuning.quick_turn_below) {
+    // Spin in place, remembering how hard so it can be braked when driving resumes
+    angular = wheel;
+    double alpha = std::min(1.0, dt / 0.1);
+    quick_stop += (std::clamp(wheel, -1.0, 1.0) * 2.0 * tuning.quick_stop - quick_stop) * alpha;
+  } else {
+    angular = fabs(throttle) * wheel * tuning.sensitivity - quick_stop;
+    double step = QUICK_STOP_DECAY * dt;
+    quick_stop -= std::clamp(quick_stop, -step, step);
+  }
+
+  limit(forward_target, angular * 127.0, dt);
+
+  // Turn rate feedback, so the same stick turns the same whatever the robot is carrying or pushing
+  double correction = 0.0;
+  if (!imu_ready) imu_ready = boot::done("imu");
+  if (imu_ready && tuning.max_rate > 0.0) {
+    double wanted = turn / 127.0 * tuning.max_rate;
+    correction = 127.0 * std::clamp(tuning.rate_kp * (wanted - heading::rate_get()), -FEEDBACK_MAX, FEEDBACK_MAX);
+  }
+
+  // Scale both sides down together past the speed limit, so the curve keeps its shape
+  double left = forward + turn + correction, right = forward - turn - correction;
+  double over = std::max(fabs(left), fabs(right)) / chassis.opcontrol_speed_max_get();
+  if (over > 1.0) {
+    left /= over;
+    right /= over;
+  }
+  motors::drive_set(left, right);
+  motors::flush(motors::DRIVE);
+  driver::record(read_us, sticks_changed);
+}
+
+}  // namespace assist
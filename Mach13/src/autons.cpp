@@ -12,6 +12,7 @@ const int SWING_SPEED = 90;
 
 ///
 // Constants
+//  These are the defaults, values saved from the PID tuner (config.hpp) are loaded over them at startup
 ///
 void default_constants() {
   chassis.pid_heading_constants_set(11.3, 0, 20);
@@ -28,6 +29,8 @@ void default_constants() {
   chassis.pid_drive_chain_constant_set(3_in);
 
   chassis.slew_drive_constants_set(7_in, 80);
+
+  motion::velocity_constants_set(1.66, 0, 0.5);  // kV is 127 / top wheel speed (3.25" wheels at 450rpm is ~76.6in/s)
 }
 
 ///
@@ -237,7 +240,7 @@ void redright() {
   chassis.pid_wait();
   chassis.pid_drive_set(-43_in, 50, true);
   chassis.pid_wait();
-  set_clamp(2);
+  set_clamp_wait(2);
   pros::delay(500);
   chassis.pid_turn_relative_set(-95_deg, TURN_SPEED);
   chassis.pid_wait();
@@ -266,7 +269,7 @@ void blueright() {
   chassis.pid_wait();
   chassis.pid_drive_set(-5_in, 40, true);
   chassis.pid_wait();
-  set_clamp(2);
+  set_clamp_wait(2);
   chassis.pid_turn_set(-5_deg, TURN_SPEED);
   chassis.pid_wait();
   inveyor.move(200);
@@ -302,7 +305,7 @@ void blueleft() {
   chassis.pid_wait();
   chassis.pid_drive_set(-43_in, 50, true);
   chassis.pid_wait();
-  set_clamp(2);
+  set_clamp_wait(2);
   pros::delay(500);
   chassis.pid_turn_relative_set(95_deg, TURN_SPEED);
   chassis.pid_wait();
@@ -331,7 +334,7 @@ void soloawp(){
   chassis.pid_wait();
   chassis.pid_drive_set(-5_in, 40, true);
   chassis.pid_wait();
-  set_clamp(2);
+  set_clamp_wait(2);
   chassis.pid_turn_set(5_deg, TURN_SPEED);
   chassis.pid_wait();
   inveyor.move(200);
@@ -349,7 +352,7 @@ chassis.pid_drive_set(-40_in, 110, true);
 chassis.pid_wait();
 chassis.pid_turn_relative_set(20_deg, TURN_SPEED);
 chassis.pid_wait();
-set_clamp(0);
+set_clamp_wait(0, 50);
 chassis.pid_turn_relative_set(-45_deg, TURN_SPEED);
 chassis.pid_wait();
 }
@@ -369,7 +372,7 @@ void skills() {
   chassis.pid_wait();
   chassis.pid_drive_set(-15, 50, true);
   chassis.pid_wait();
-  set_clamp(2);
+  set_clamp_wait(2);
   pros::delay(3000);
   inveyor.move(200);
   // Get and score first Ring
@@ -407,7 +410,7 @@ void skills() {
   chassis.pid_wait();
   chassis.pid_drive_set(-8_in, 90, true);
   chassis.pid_wait();
-  set_clamp(0);
+  set_clamp_wait(0, 50);
   pros::delay(500);
   chassis.pid_drive_set(9_in, 90, true);
   chassis.pid_wait();
@@ -417,7 +420,7 @@ void skills() {
   chassis.pid_wait();
   chassis.pid_drive_set(-10_in, 50, true);
   chassis.pid_wait();
-  set_clamp(2);
+  set_clamp_wait(2);
   chassis.pid_drive_set(-3, 60, true);
   chassis.pid_wait();
   chassis.pid_turn_relative_set(90_deg, TURN_SPEED);
@@ -452,7 +455,7 @@ void skills() {
   chassis.pid_wait();
   chassis.pid_drive_set(-8_in, 90, true);
   chassis.pid_wait();
-  set_clamp(0);
+  set_clamp_wait(0, 50);
   pros::delay(1000);
   chassis.pid_drive_set(24_in, 90, true);
   chassis.pid_wait();
@@ -0,0 +1,116 @@
+#include "boot.hpp"
+
+#include <atomic>
+#include <list>
+
+#include "logging.hpp"
+
+namespace boot {
+namespace {
+struct stage_t {
+  std::string name;
+  std::function<void()> run;
+  std::vector<stage_t*> depends_on;
+  std::vector<std::string> depends_on_names;
+  uint32_t queued = 0;
+  uint32_t started = 0;
+  uint32_t finished = 0;
+  std::atomic<bool> is_done{false};
+};
+
+// std::list so pointers to stages stay valid as stages are added
+std::list<stage_t> stages;
+bool is_started = false;
+
+stage_t* find(std::string name) {
+  for (auto& stage : stages) {
+    if (stage.name == name) return &stage;
+  }
+  return nullptr;
+}
+
+void stage_task(stage_t* stage) {
+  for (auto dependency : stage->depends_on) {
+    while (!dependency->is_done) pros::delay(2);
+  }
+  stage->started = pros::millis();
+  stage->run();
+  stage->finished = pros::millis();
+  stage->is_done = true;
+}
+}  // namespace
+
+void stage_add(std::string name, std::function<void()> stage, std::vector<std::string> depends_on) {
+  if (is_started) {
+    LOGW("boot: stage '%s' added after start(), ignoring it", name);
+    return;
+  }
+  stages.emplace_back();
+  stages.back().name = name;
+  stages.back().run = stage;
+  stages.back().depends_on_names = depends_on;
+}
+
+void start() {
+  if (is_started) return;
+  is_started = true;
+
+  // Resolve names first so a typo is caught before anything runs
+  for (auto& stage : stages) {
+    for (auto& name : stage.depends_on_names) {
+      stage_t* dependency = find(name);
+      if (dependency == nullptr || dependency == &stage) {
+        LOGW("boot: stage '%s' depends on unknown stage '%s', ignoring the dependency", stage.name, name);
+        continue;
+      }
+      stage.depends_on.push_back(dependency);
+    }
+  }
+
+  for (auto& stage : stages) {
+    stage_t* s = &stage;
+    s->queued = pros::millis();
+    pros::Task task([s]() { stage_task(s); }, TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_DEFAULT, s->name.c_str());
+  }
+}
+
+bool done(std::string name) {
+  stage_t* stage = find(name);
+  return stage != nullptr && stage->is_done;
+}
+
+bool wait(std::vector<std::string> names, uint32_t timeout) {
+  uint32_t start_time = pros::millis();
+  for (auto& name : names) {
+    stage_t* stage = find(name);
+    if (stage == nullptr) continue;
+    while (!stage->is_done) {
+      if (timeout != TIMEOUT_MAX && pros::millis() - start_time >= timeout) return false;
+      pros::delay(2);
+    }
+  }
+  return true;
+}
+
+bool wait_all(uint32_t timeout) {
+  std::vector<std::string> names;
+  for (auto& stage : stages) names.push_back(stage.name);
+  return wait(names, timeout);
+}
+
+void timeline_print() {
+  printf("\nStartup timeline (ms since program start)\n");
+  uint32_t last = 0;
+  for (auto& stage : stages) {
+    if (!stage.is_done) {
+      printf("  %-12s queued %5lu  still running\n", stage.name.c_str(), (unsigned long)stage.queued);
+      continue;
+    }
+    printf("  %-12s queued %5lu  start %5lu  end %5lu  took %5lu\n", stage.name.c_str(), (unsigned long)stage.queued,
+           (unsigned long)stage.started, (unsigned long)stage.finished, (unsigned long)(stage.finished - stage.started));
+    last = std::max(last, stage.finished);
+  }
+  printf("  ready at %lu ms\n\n", (unsigned long)last);
+}
+
+}  // namespace boot
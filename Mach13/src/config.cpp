@@ -0,0 +1,177 @@
+#include "config.hpp"
+
+#include "crc.hpp"
+#include "main.h"
+
+namespace config {
+namespace {
+const uint32_t MAGIC = 0x4346334D;  // "M3FC" on disk, little endian
+const char* const TEMP_PATH = "/usd/m13_config.tmp";
+
+typedef struct header_t {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t size;
+  uint32_t crc;
+} header_t;
+
+static_assert(std::is_trivially_copyable<values_t>::value, "values_t is written to the SD card as raw bytes");
+static_assert(sizeof(values_t) < UINT16_MAX, "values_t has to fit the header's size field");
+
+pros::Mutex file_mutex;
+
+pid_gains gains_from(PID::Constants c) { return {(float)c.kp, (float)c.ki, (float)c.kd, (float)c.start_i}; }
+
+exit_gains exit_from(PID::exit_condition_ e) {
+  return {e.small_exit_time, (float)e.small_error, e.big_exit_time, (float)e.big_error, e.velocity_exit_time, e.mA_timeout};
+}
+
+// Checks a file's header and copies its payload over values.  Older, shorter files only overwrite what they have.
+bool parse(const uint8_t* buffer, size_t length) {
+  if (length < sizeof(header_t)) return false;
+  header_t header;
+  memcpy(&header, buffer, sizeof(header));
+  if (header.magic != MAGIC || header.version > VERSION || header.size > length - sizeof(header_t)) return false;
+  if (crc::crc32(buffer + sizeof(header_t), header.size) != header.crc) return false;
+
+  values_t loaded = values;
+  memcpy(&loaded, buffer + sizeof(header_t), std::min((size_t)header.size, sizeof(values_t)));
+  values = loaded;
+  return true;
+}
+
+bool read_file(const char* path) {
+  FILE* file = fopen(path, "rb");
+  if (file == nullptr) return false;
+
+  // One read for the whole file, leaving room for files from a newer version
+  static uint8_t buffer[sizeof(header_t) + 2 * sizeof(values_t)];
+  size_t length = fread(buffer, 1, sizeof(buffer), file);
+  fclose(file);
+  return parse(buffer, length);
+}
+
+bool write_file(const char* path, const values_t& to_write) {
+  header_t header = {MAGIC, VERSION, (uint16_t)sizeof(values_t), crc::crc32(&to_write, sizeof(values_t))};
+  FILE* file = fopen(path, "wb");
+  if (file == nullptr) return false;
+  bool ok = fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(&to_write, sizeof(values_t), 1, file) == 1;
+  ok = fflush(file) == 0 && ok;
+  return fclose(file) == 0 && ok;
+}
+}  // namespace
+
+values_t values = {};
+
+void capture() {
+  values.drive_forward = gains_from(chassis.pid_drive_constants_forward_get());
+  values.drive_backward = gains_from(chassis.pid_drive_constants_backward_get());
+  values.heading = gains_from(chassis.pid_heading_constants_get());
+  values.turn = gains_from(chassis.pid_turn_constants_get());
+  values.swing_forward = gains_from(chassis.pid_swing_constants_forward_get());
+  values.swing_backward = gains_from(chassis.pid_swing_constants_backward_get());
+  values.odom_angular = gains_from(chassis.odom_angularPID.constants);
+  values.boomerang = gains_from(chassis.boomerangPID.constants);
+
+  values.drive_exit = exit_from(chassis.leftPID.exit);
+  values.turn_exit = exit_from(chassis.turnPID.exit);
+  values.swing_exit = exit_from(chassis.swingPID.exit);
+
+  values.drive_chain_forward = chassis.pid_drive_chain_forward_constant_get();
+  values.drive_chain_backward = chassis.pid_drive_chain_backward_constant_get();
+  values.turn_chain = chassis.pid_turn_chain_constant_get();
+  values.swing_chain_forward = chassis.pid_swing_chain_forward_constant_get();
+  values.swing_chain_backward = chassis.pid_swing_chain_backward_constant_get();
+
+  values.slew_drive_forward = {(float)chassis.slew_forward.constants_get().distance_to_travel, (int32_t)chassis.slew_forward.constants_get().min_speed};
+  values.slew_drive_backward = {(float)chassis.slew_backward.constants_get().distance_to_travel, (int32_t)chassis.slew_backward.constants_get().min_speed};
+
+  std::vector<double> curves = chassis.opcontrol_curve_default_get();
+  values.curve_left = curves.size() > 0 ? curves[0] : 0;
+  values.curve_right = curves.size() > 1 ? curves[1] : 0;
+
+  values.ldb_speed = LDB_SPEED;
+  values.ldb_min_angle = MIN_ANGLE;
+  values.ldb_load_angle = LOAD_ANGLE;
+  values.ldb_max_angle = MAX_ANGLE;
+}
+
+void apply() {
+  auto& v = values;
+  chassis.pid_drive_constants_forward_set(v.drive_forward.kp, v.drive_forward.ki, v.drive_forward.kd, v.drive_forward.start_i);
+  chassis.pid_drive_constants_backward_set(v.drive_backward.kp, v.drive_backward.ki, v.drive_backward.kd, v.drive_backward.start_i);
+  chassis.pid_heading_constants_set(v.heading.kp, v.heading.ki, v.heading.kd, v.heading.start_i);
+  chassis.pid_turn_constants_set(v.turn.kp, v.turn.ki, v.turn.kd, v.turn.start_i);
+  chassis.pid_swing_constants_forward_set(v.swing_forward.kp, v.swing_forward.ki, v.swing_forward.kd, v.swing_forward.start_i);
+  chassis.pid_swing_constants_backward_set(v.swing_backward.kp, v.swing_backward.ki, v.swing_backward.kd, v.swing_backward.start_i);
+  chassis.pid_odom_angular_constants_set(v.odom_angular.kp, v.odom_angular.ki, v.odom_angular.kd, v.odom_angular.start_i);
+  chassis.pid_odom_boomerang_constants_set(v.boomerang.kp, v.boomerang.ki, v.boomerang.kd, v.boomerang.start_i);
+
+  chassis.pid_drive_exit_condition_set(v.drive_exit.small_exit_time, v.drive_exit.small_error, v.drive_exit.big_exit_time, v.drive_exit.big_error, v.drive_exit.velocity_exit_time, v.drive_exit.mA_timeout);
+  chassis.pid_turn_exit_condition_set(v.turn_exit.small_exit_time, v.turn_exit.small_error, v.turn_exit.big_exit_time, v.turn_exit.big_error, v.turn_exit.velocity_exit_time, v.turn_exit.mA_timeout);
+  chassis.pid_swing_exit_condition_set(v.swing_exit.small_exit_time, v.swing_exit.small_error, v.swing_exit.big_exit_time, v.swing_exit.big_error, v.swing_exit.velocity_exit_time, v.swing_exit.mA_timeout);
+
+  chassis.pid_drive_chain_forward_constant_set(v.drive_chain_forward);
+  chassis.pid_drive_chain_backward_constant_set(v.drive_chain_backward);
+  chassis.pid_turn_chain_constant_set(v.turn_chain);
+  chassis.pid_swing_chain_forward_constant_set(v.swing_chain_forward);
+  chassis.pid_swing_chain_backward_constant_set(v.swing_chain_backward);
+
+  chassis.slew_drive_constants_forward_set(v.slew_drive_forward.distance * okapi::inch, v.slew_drive_forward.min_speed);
+  chassis.slew_drive_constants_backward_set(v.slew_drive_backward.distance * okapi::inch, v.slew_drive_backward.min_speed);
+
+  chassis.opcontrol_curve_default_set(v.curve_left, v.curve_right);
+
+  LDB_SPEED = v.ldb_speed;
+  MIN_ANGLE = v.ldb_min_angle;
+  LOAD_ANGLE = v.ldb_load_angle;
+  MAX_ANGLE = v.ldb_max_angle;
+}
+
+bool load() {
+  if (!ez::util::SD_CARD_ACTIVE) return false;
+
+  // Defaults fill anything an older file doesn't have
+  capture();
+
+  file_mutex.take();
+  bool ok = read_file(PATH);
+  // A save that lost power before the rename leaves a good temporary file behind
+  if (!ok) ok = read_file(TEMP_PATH);
+  file_mutex.give();
+
+  if (ok) {
+    apply();
+    LOGI("Loaded tuned constants from %s", PATH);
+  } else {
+    LOGW("No valid config on the SD card, using default_constants()");
+  }
+  return ok;
+}
+
+bool save() {
+  if (!ez::util::SD_CARD_ACTIVE) return false;
+  capture();
+  values_t to_write = values;
+
+  file_mutex.take();
+  bool ok = write_file(TEMP_PATH, to_write);
+  if (ok) {
+    remove(PATH);
+    // If the filesystem can't rename, write the real file too so the next boot still finds it
+    if (rename(TEMP_PATH, PATH) != 0) ok = write_file(PATH, to_write);
+  }
+  file_mutex.give();
+
+  if (ok)
+    LOGI("Saved tuned constants to %s", PATH);
+  else
+    LOGE("Failed to save tuned constants to %s", PATH);
+  return ok;
+}
+
+void save_async() {
+  pros::Task save_task([]() { save(); }, TASK_PRIORITY_MIN + 1, TASK_STACK_DEPTH_DEFAULT, "Config Save");
+}
+
+}  // namespace config
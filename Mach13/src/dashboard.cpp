@@ -0,0 +1,504 @@
+#include "dashboard.hpp"
+
+#include "liblvgl/lvgl.h"
+#include "main.h"
+
+namespace dashboard {
+namespace {
+// Layout, the field takes the left square of the 480x240 screen
+const int FIELD_PX = 240;
+const double FIELD_IN = 144.0;
+const double PX_PER_IN = FIELD_PX / FIELD_IN;
+const int ROBOT_PX = 24;
+const int HEADING_PX = 11;
+const int TARGET_PX = 8;
+const int PATH_POINTS_MAX = 64;
+const int ROW_PX = 21;
+const int TEMP_MIN = 20;
+const int TEMP_MAX = 70;
+const int TEMP_HOT = 55;
+const int CURRENT_MAX = 2500;
+const int MOTORS_PER_UPDATE = 3;
+
+struct motor_row {
+  const char* name;
+  pros::AbstractMotor* motor;
+  uint8_t index;
+  lv_obj_t* temp_bar = nullptr;
+  lv_obj_t* current_bar = nullptr;
+  int shown_temp = -1;
+  int shown_current = -1;
+};
+
+// Timers waiting for LVGL's task to create them, see timer_start()
+typedef struct pending_timer {
+  lv_timer_cb_t callback;
+  uint32_t period_ms;
+  void* user_data;
+} pending_timer;
+pros::Mutex pending_mutex;
+std::vector<pending_timer> pending;
+lv_timer_cb_t refresh_cb = nullptr;  // the display's own refresh while refresh_hook() stands in for it
+bool started = false;                // only touched by initialize()
+
+// Objects, only touched from update(), which LVGL runs in its own task between redraws
+lv_obj_t* screen = nullptr;
+lv_obj_t* last_screen = nullptr;
+lv_obj_t* robot = nullptr;
+lv_obj_t* heading = nullptr;
+lv_obj_t* target = nullptr;
+lv_obj_t* path = nullptr;
+lv_obj_t* pose_label = nullptr;
+lv_obj_t* cpu_label = nullptr;
+lv_obj_t* message_label = nullptr;
+lv_point_t heading_points[2];
+lv_point_t path_points[PATH_POINTS_MAX];
+lv_point_t tile_points[10][2];
+std::vector<motor_row> rows;
+int next_row = 0;
+
+// What is currently drawn, so objects are only invalidated when something changes
+int shown_x = INT32_MIN, shown_y = INT32_MIN, shown_heading = INT32_MIN;
+int shown_target_x = INT32_MIN, shown_target_y = INT32_MIN;
+int shown_pose[3] = {INT32_MIN, INT32_MIN, INT32_MIN};
+int shown_load = -1;
+
+// Inputs from other tasks, guarded by data_mutex
+pros::Mutex data_mutex;
+std::vector<ez::pose> path_in;
+bool path_dirty = false;
+ez::pose target_in;
+bool target_on = false;
+double origin_x = FIELD_IN / 2.0, origin_y = FIELD_IN / 2.0;
+bool origin_dirty = false;
+bool show_wanted = false;
+std::string message_in;
+uint32_t message_color = 0xFFFFFF;
+bool message_dirty = false;
+
+// The origin update() draws with, copied from origin_x/y under data_mutex
+double view_x = FIELD_IN / 2.0, view_y = FIELD_IN / 2.0;
+
+// CPU accounting
+double budget_pct = 1.0;
+uint32_t min_period = 50;
+uint32_t max_period = 500;
+cpu_stats stats = {0, 0, 0, 0, 50, 0.0};
+uint32_t redraw_us = 0;  // LVGL's render and flush time since the last update
+void (*chained_monitor)(lv_disp_drv_t*, uint32_t, uint32_t) = nullptr;
+bool is_shown = false;
+
+int to_px_x(double x) { return (int)std::round((view_x + x) * PX_PER_IN); }
+int to_px_y(double y) { return FIELD_PX - (int)std::round((view_y + y) * PX_PER_IN); }
+
+lv_obj_t* box_create(lv_obj_t* parent, int w, int h, uint32_t color) {
+  lv_obj_t* obj = lv_obj_create(parent);
+  lv_obj_remove_style_all(obj);
+  lv_obj_set_size(obj, w, h);
+  lv_obj_set_style_bg_opa(obj, LV_OPA_COVER, LV_PART_MAIN);
+  lv_obj_set_style_bg_color(obj, lv_color_hex(color), LV_PART_MAIN);
+  lv_obj_clear_flag(obj, LV_OBJ_FLAG_SCROLLABLE | LV_OBJ_FLAG_CLICKABLE);
+  return obj;
+}
+
+lv_obj_t* line_create(lv_obj_t* parent, int width, uint32_t color) {
+  lv_obj_t* obj = lv_line_create(parent);
+  lv_obj_set_style_line_width(obj, width, LV_PART_MAIN);
+  lv_obj_set_style_line_color(obj, lv_color_hex(color), LV_PART_MAIN);
+  lv_obj_set_style_line_rounded(obj, true, LV_PART_MAIN);
+  lv_obj_clear_flag(obj, LV_OBJ_FLAG_CLICKABLE);
+  return obj;
+}
+
+lv_obj_t* bar_create(lv_obj_t* parent, int x, int y, int min, int max) {
+  lv_obj_t* obj = lv_bar_create(parent);
+  lv_obj_set_size(obj, 90, 8);
+  lv_obj_set_pos(obj, x, y);
+  lv_bar_set_range(obj, min, max);
+  lv_obj_set_style_anim_time(obj, 0, LV_PART_MAIN);
+  return obj;
+}
+
+void field_build() {
+  lv_obj_t* field = box_create(screen, FIELD_PX, FIELD_PX, 0x505050);
+
+  // Tile lines never change, so they are only drawn when the screen is loaded
+  for (int i = 1; i < 6; i++) {
+    int p = i * FIELD_PX / 6;
+    tile_points[i - 1][0] = {(lv_coord_t)p, 0};
+    tile_points[i - 1][1] = {(lv_coord_t)p, FIELD_PX};
+    tile_points[i + 4][0] = {0, (lv_coord_t)p};
+    tile_points[i + 4][1] = {FIELD_PX, (lv_coord_t)p};
+  }
+  for (int i = 0; i < 10; i++) {
+    lv_line_set_points(line_create(field, 1, 0x707070), tile_points[i], 2);
+  }
+
+  path = line_create(field, 2, 0x00C0FF);
+  lv_obj_add_flag(path, LV_OBJ_FLAG_HIDDEN);
+
+  target = box_create(field, TARGET_PX, TARGET_PX, 0xFFD000);
+  lv_obj_set_style_radius(target, LV_RADIUS_CIRCLE, LV_PART_MAIN);
+  lv_obj_add_flag(target, LV_OBJ_FLAG_HIDDEN);
+
+  // The robot is one small container so a move only invalidates its old and new area
+  robot = lv_obj_create(field);
+  lv_obj_remove_style_all(robot);
+  lv_obj_set_size(robot, ROBOT_PX, ROBOT_PX);
+  lv_obj_clear_flag(robot, LV_OBJ_FLAG_SCROLLABLE | LV_OBJ_FLAG_CLICKABLE);
+  lv_obj_t* body = box_create(robot, ROBOT_PX - 6, ROBOT_PX - 6, 0xE03030);
+  lv_obj_set_style_radius(body, 4, LV_PART_MAIN);
+  lv_obj_center(body);
+  heading = line_create(robot, 3, 0xFFFFFF);
+}
+
+void motors_build() {
+  pose_label = lv_label_create(screen);
+  lv_obj_set_pos(pose_label, FIELD_PX + 8, 2);
+  lv_label_set_text(pose_label, "");
+
+  static const char* left_names[] = {"L1", "L2", "L3", "L4"};
+  static const char* right_names[] = {"R1", "R2", "R3", "R4"};
+  static const char* ldb_names[] = {"LB1", "LB2"};
+  for (size_t i = 0; i < chassis.left_motors.size() && i < 4; i++)
+    rows.push_back({left_names[i], &chassis.left_motors[i], 0});
+  for (size_t i = 0; i < chassis.right_motors.size() && i < 4; i++)
+    rows.push_back({right_names[i], &chassis.right_motors[i], 0});
+  rows.push_back({"Conv", &inveyor, 0});
+  for (int i = 0; i < ladybrown.size() && i < 2; i++)
+    rows.push_back({ldb_names[i], &ladybrown, (uint8_t)i});
+
+  int y = 24;
+  for (auto& row : rows) {
+    lv_obj_t* name = lv_label_create(screen);
+    lv_obj_set_pos(name, FIELD_PX + 8, y - 4);
+    lv_label_set_text_static(name, row.name);
+    row.temp_bar = bar_create(screen, FIELD_PX + 45, y, TEMP_MIN, TEMP_MAX);
+    row.current_bar = bar_create(screen, FIELD_PX + 140, y, 0, CURRENT_MAX);
+    y += ROW_PX;
+  }
+
+  cpu_label = lv_label_create(screen);
+  lv_obj_set_pos(cpu_label, FIELD_PX + 8, FIELD_PX - 20);
+  lv_label_set_text(cpu_label, "");
+
+  message_label = lv_label_create(screen);
+  lv_obj_set_pos(message_label, FIELD_PX + 8, FIELD_PX - 36);  // Between the last motor row and the cpu line
+  lv_obj_set_width(message_label, 480 - FIELD_PX - 16);
+  lv_label_set_long_mode(message_label, LV_LABEL_LONG_DOT);
+  lv_label_set_text(message_label, "");
+}
+
+void robot_update() {
+  ez::pose current = tracking::pose_get();
+  int x = to_px_x(current.x) - ROBOT_PX / 2;
+  int y = to_px_y(current.y) - ROBOT_PX / 2;
+  if (x != shown_x || y != shown_y) {
+    lv_obj_set_pos(robot, x, y);
+    shown_x = x;
+    shown_y = y;
+  }
+
+  // Heading is redrawn in 5 degree steps, finer than that isn't visible at this size
+  int step = (int)std::round(current.theta / 5.0);
+  if (step != shown_heading) {
+    double rad = ez::util::to_rad(step * 5.0);
+    heading_points[0] = {ROBOT_PX / 2, ROBOT_PX / 2};
+    heading_points[1] = {(lv_coord_t)(ROBOT_PX / 2 + std::round(HEADING_PX * sin(rad))),
+                         (lv_coord_t)(ROBOT_PX / 2 - std::round(HEADING_PX * cos(rad)))};
+    lv_line_set_points(heading, heading_points, 2);
+    shown_heading = step;
+  }
+
+  int pose_now[3] = {(int)std::round(current.x * 10), (int)std::round(current.y * 10), (int)std::round(current.theta)};
+  if (memcmp(pose_now, shown_pose, sizeof(pose_now)) != 0) {
+    lv_label_set_text_fmt(pose_label, "x %.1f  y %.1f  %d deg", pose_now[0] / 10.0, pose_now[1] / 10.0, pose_now[2]);
+    memcpy(shown_pose, pose_now, sizeof(pose_now));
+  }
+}
+
+void plan_update() {
+  std::vector<ez::pose> new_path;
+  bool new_path_ready = false;
+  bool show_target;
+  ez::pose new_target;
+  data_mutex.take();
+  if (path_dirty) {
+    new_path = path_in;
+    path_dirty = false;
+    new_path_ready = true;
+  }
+  show_target = target_on;
+  new_target = target_in;
+  if (origin_dirty) {
+    view_x = origin_x;
+    view_y = origin_y;
+    origin_dirty = false;
+    shown_x = shown_target_x = INT32_MIN;
+  }
+  data_mutex.give();
+
+  if (new_path_ready) {
+    if (new_path.size() < 2) {
+      lv_obj_add_flag(path, LV_OBJ_FLAG_HIDDEN);
+    } else {
+      // Long injected paths are decimated so the line stays cheap to draw
+      int count = std::min((int)new_path.size(), PATH_POINTS_MAX);
+      for (int i = 0; i < count; i++) {
+        size_t src = (size_t)i * (new_path.size() - 1) / (count - 1);
+        path_points[i] = {(lv_coord_t)to_px_x(new_path[src].x), (lv_coord_t)to_px_y(new_path[src].y)};
+      }
+      lv_line_set_points(path, path_points, count);
+      lv_obj_clear_flag(path, LV_OBJ_FLAG_HIDDEN);
+    }
+  }
+
+  if (!show_target) {
+    if (shown_target_x != INT32_MIN) {
+      lv_obj_add_flag(target, LV_OBJ_FLAG_HIDDEN);
+      shown_target_x = shown_target_y = INT32_MIN;
+    }
+    return;
+  }
+  int x = to_px_x(new_target.x) - TARGET_PX / 2;
+  int y = to_px_y(new_target.y) - TARGET_PX / 2;
+  if (x != shown_target_x || y != shown_target_y) {
+    lv_obj_set_pos(target, x, y);
+    if (shown_target_x == INT32_MIN) lv_obj_clear_flag(target, LV_OBJ_FLAG_HIDDEN);
+    shown_target_x = x;
+    shown_target_y = y;
+  }
+}
+
+void message_update() {
+  data_mutex.take();
+  if (!message_dirty) {
+    data_mutex.give();
+    return;
+  }
+  std::string text = message_in;
+  uint32_t color = message_color;
+  message_dirty = false;
+  data_mutex.give();
+
+  lv_label_set_text(message_label, text.c_str());
+  lv_obj_set_style_text_color(message_label, lv_color_hex(color), LV_PART_MAIN);
+}
+
+void motors_update() {
+  // Only a few motors are read per update to spread the device calls out
+  for (int n = 0; n < MOTORS_PER_UPDATE && !rows.empty(); n++) {
+    motor_row& row = rows[next_row];
+    next_row = (next_row + 1) % rows.size();
+
+    int temp = (int)row.motor->get_temperature(row.index);
+    int current = row.motor->get_current_draw(row.index);
+    if (temp == PROS_ERR || current == PROS_ERR) continue;
+
+    // Current is drawn in 50mA steps so noise doesn't redraw the bar every update
+    current = std::clamp(current / 50 * 50, 0, CURRENT_MAX);
+    if (temp != row.shown_temp) {
+      lv_bar_set_value(row.temp_bar, std::clamp(temp, TEMP_MIN, TEMP_MAX), LV_ANIM_OFF);
+      lv_obj_set_style_bg_color(row.temp_bar, lv_color_hex(temp >= TEMP_HOT ? 0xE03030 : 0x30C030), LV_PART_INDICATOR);
+      row.shown_temp = temp;
+    }
+    if (current != row.shown_current) {
+      lv_bar_set_value(row.current_bar, current, LV_ANIM_OFF);
+      row.shown_current = current;
+    }
+  }
+}
+
+// Called by LVGL after each refresh, the redraw time is charged to the dashboard while it's shown
+void redraw_done(lv_disp_drv_t* driver, uint32_t time_ms, uint32_t px) {
+  if (is_shown) redraw_us += time_ms * 1000;
+  if (chained_monitor) chained_monitor(driver, time_ms, px);
+}
+
+void cpu_update(uint32_t update_us) {
+  // LVGL only reports whole milliseconds, so short redraws round down to 0
+  uint32_t redraw = redraw_us;
+  uint32_t cost_us = update_us + redraw;
+  redraw_us = 0;
+  stats.last_us = cost_us;
+  stats.redraw_us = (stats.redraw_us * 7 + redraw) / 8;
+  stats.avg_us = stats.avg_us == 0 ? cost_us : (stats.avg_us * 7 + cost_us) / 8;
+  stats.peak_us = std::max(stats.peak_us, cost_us);
+  stats.load_pct = stats.avg_us / (stats.period_ms * 10.0);
+
+  // Stretch the period when over budget, and come back down once there's room again
+  if (stats.load_pct > budget_pct) {
+    stats.period_ms = std::min(max_period, stats.period_ms * 2);
+  } else if (stats.load_pct < budget_pct * 0.25 && stats.period_ms > min_period) {
+    stats.period_ms = std::max(min_period, stats.period_ms - 10);
+  }
+
+  int load = (int)std::round(stats.load_pct * 100.0);
+  if (load != shown_load) {
+    lv_label_set_text_fmt(cpu_label, "ui %d.%02d%%  %lums", load / 100, load % 100, (unsigned long)stats.period_ms);
+    shown_load = load;
+  }
+}
+
+void build() {
+  screen = lv_obj_create(NULL);
+  lv_obj_set_style_bg_color(screen, lv_color_hex(0x101010), LV_PART_MAIN);
+  lv_obj_set_style_text_color(screen, lv_color_hex(0xFFFFFF), LV_PART_MAIN);
+  lv_obj_clear_flag(screen, LV_OBJ_FLAG_SCROLLABLE);
+  field_build();
+  motors_build();
+
+  lv_disp_t* display = lv_disp_get_default();
+  if (display && display->driver->monitor_cb != redraw_done) {
+    chained_monitor = display->driver->monitor_cb;
+    display->driver->monitor_cb = redraw_done;
+  }
+}
+
+void screen_update() {
+  data_mutex.take();
+  bool want = show_wanted;
+  data_mutex.give();
+  if (want == is_shown) return;
+  if (want) {
+    last_screen = lv_scr_act();
+    lv_scr_load(screen);
+  } else if (last_screen) {
+    lv_scr_load(last_screen);
+  }
+  is_shown = want;
+}
+
+// Runs in LVGL's task in place of the display's refresh timer, once.  Puts the refresh back, runs
+// it, then creates the waiting timers
+void refresh_hook(lv_timer_t* refresh) {
+  pending_mutex.take();
+  refresh->timer_cb = refresh_cb;
+  refresh_cb = nullptr;
+  std::vector<pending_timer> list;
+  list.swap(pending);
+  pending_mutex.give();
+  refresh->timer_cb(refresh);
+  for (auto& p : list) lv_timer_create(p.callback, p.period_ms, p.user_data);
+}
+
+// PROS exports no LVGL lock, and lv_timer_create() changes the list LVGL's task walks, so it's only
+// called from that task.  The display's refresh timer, which LVGL runs every refresh period whether
+// or not anything changed, is pointed at refresh_hook() for one run.  That one pointer is all another
+// task writes, and LVGL reads it whole.  Returns false if there's no display
+bool timer_start(lv_timer_cb_t callback, uint32_t period_ms, void* user_data) {
+  lv_disp_t* display = lv_disp_get_default();
+  if (!display || !display->refr_timer) {
+    LOGW("Dashboard: no display to run a timer on");
+    return false;
+  }
+  pending_mutex.take();
+  pending.push_back({callback, period_ms, user_data});
+  if (!refresh_cb) {
+    refresh_cb = display->refr_timer->timer_cb;
+    display->refr_timer->timer_cb = refresh_hook;
+  }
+  pending_mutex.give();
+  return true;
+}
+
+// PROS exports no LVGL lock, so the dashboard runs as an LVGL timer, in LVGL's task between redraws.
+// Everything here only reads cached device values, none of it blocks
+void update(lv_timer_t* self) {
+  if (!screen) build();
+  screen_update();
+  if (is_shown) {
+    uint64_t start = pros::micros();
+    robot_update();
+    plan_update();
+    motors_update();
+    message_update();
+    cpu_update((uint32_t)(pros::micros() - start));
+  }
+  lv_timer_set_period(self, stats.period_ms);
+}
+}  // namespace
+
+void initialize() {
+  if (started) return;
+  stats.period_ms = min_period;
+  started = timer_start(update, min_period, nullptr);  // The screen is built on the first run
+}
+
+void lvgl_run(uint32_t period_ms, std::function<void()> run) {
+  auto call = [](lv_timer_t* self) { (*(std::function<void()>*)self->user_data)(); };
+  auto copy = new std::function<void()>(run);  // Lives as long as the timer, which is forever
+  if (!timer_start(call, period_ms, copy)) delete copy;
+}
+
+void show() {
+  data_mutex.take();
+  show_wanted = true;
+  data_mutex.give();
+}
+
+void hide() {
+  data_mutex.take();
+  show_wanted = false;
+  data_mutex.give();
+}
+
+bool shown() { return is_shown; }
+
+void origin_set(double x, double y) {
+  data_mutex.take();
+  origin_x = x;
+  origin_y = y;
+  origin_dirty = true;
+  path_dirty = true;
+  data_mutex.give();
+}
+
+void path_set(std::vector<ez::pose> new_path) {
+  data_mutex.take();
+  path_in = new_path;
+  path_dirty = true;
+  data_mutex.give();
+}
+
+void path_set(std::vector<ez::odom> new_path) {
+  std::vector<ez::pose> poses;
+  poses.reserve(new_path.size() + 1);
+  poses.push_back(tracking::pose_get());
+  for (auto& movement : new_path) poses.push_back(movement.target);
+  path_set(poses);
+}
+
+void path_clear() { path_set(std::vector<ez::pose>{}); }
+
+void target_set(ez::pose new_target) {
+  data_mutex.take();
+  target_in = new_target;
+  target_on = true;
+  data_mutex.give();
+}
+
+void target_clear() {
+  data_mutex.take();
+  target_on = false;
+  data_mutex.give();
+}
+
+void message_set(const std::string& text, uint32_t color) {
+  data_mutex.take();
+  message_in = text;
+  message_color = color;
+  message_dirty = true;
+  data_mutex.give();
+}
+
+void cpu_budget_set(double pct, uint32_t min_period_ms, uint32_t max_period_ms) {
+  budget_pct = pct;
+  min_period = min_period_ms;
+  max_period = std::max(min_period_ms, max_period_ms);
+  stats.period_ms = std::clamp(stats.period_ms, min_period, max_period);
+}
+
+cpu_stats cpu_get() { return stats; }
+
+}  // namespace dashboard
@@ -0,0 +1,125 @@
+#include "driver.hpp"
+
+#include "main.h"
+
+namespace driver {
+namespace {
+const uint32_t PERIOD = 5;  // ms, twice opcontrol()'s rate
+
+pros::Mutex mutex;
+bool added = false;
+bool active = false;
+ez::e_type type = ez::SPLIT;
+bool curvature_mode = false;
+
+// Running mean and variance, Welford's method
+typedef struct spread {
+  uint32_t n = 0;
+  double mean = 0.0;
+  double m2 = 0.0;
+
+  void add(double x) {
+    n++;
+    double delta = x - mean;
+    mean += delta / n;
+    m2 += delta * (x - mean);
+  }
+  double deviation() const { return n > 1 ? sqrt(m2 / (n - 1)) : 0.0; }
+} spread;
+
+uint32_t commands = 0;
+uint32_t last_read = 0;
+uint32_t read_to_cmd_max = 0;
+spread read_to_cmd, poll;
+
+void run() {
+  mutex.take();
+  bool driving = active;
+  ez::e_type stick_type = type;
+  bool curvature = curvature_mode;
+  mutex.give();
+
+  // opcontrol() is stopped when disabled or in autonomous, this task isn't
+  if (!driving || pros::competition::is_disabled() || pros::competition::is_autonomous()) return;
+
+  if (curvature)
+    assist::curvature(stick_type, true);
+  else
+    assist::arcade(stick_type, true);
+}
+}  // namespace
+
+void start(ez::e_type stick_type, bool curvature) {
+  mutex.take();
+  type = stick_type;
+  curvature_mode = curvature;
+  bool was_active = active;
+  active = true;
+  bool add = !added;
+  added = true;
+  mutex.give();
+  if (!was_active) latency_reset();  // Don't mix in opcontrol()'s numbers
+  if (add) jobs::add("Drive", PERIOD, jobs::CONTROL, run);
+}
+
+void resume() {
+  mutex.take();
+  ez::e_type stick_type = type;
+  bool curvature = curvature_mode;
+  mutex.give();
+  start(stick_type, curvature);
+}
+
+void stop() {
+  mutex.take();
+  active = false;
+  mutex.give();
+}
+
+bool running() {
+  mutex.take();
+  bool copy = active;
+  mutex.give();
+  return copy;
+}
+
+void record(uint32_t read_us, bool changed) {
+  uint32_t now = pros::micros();
+  mutex.take();
+  if (commands > 0 && read_us != last_read) poll.add(read_us - last_read);
+  last_read = read_us;
+  commands++;
+  if (changed) {
+    uint32_t elapsed = now - read_us;
+    read_to_cmd.add(elapsed);
+    read_to_cmd_max = std::max(read_to_cmd_max, elapsed);
+  }
+  mutex.give();
+}
+
+latency_t latency_get() {
+  mutex.take();
+  latency_t l = {commands, read_to_cmd.n, read_to_cmd.mean, read_to_cmd.deviation(), read_to_cmd_max,
+                 poll.mean, poll.deviation(), poll.mean / 2.0 + read_to_cmd.mean};
+  mutex.give();
+  return l;
+}
+
+void latency_reset() {
+  mutex.take();
+  commands = 0;
+  read_to_cmd_max = 0;
+  read_to_cmd = spread();
+  poll = spread();
+  mutex.give();
+}
+
+void print() {
+  latency_t l = latency_get();
+  printf("Driver: %s, %lu commands, %lu with the sticks moving\n", running() ? "driver task" : "opcontrol", (unsigned long)l.commands,
+         (unsigned long)l.changes);
+  printf("  read to command %.0fus (jitter %.0fus, max %luus), reads every %.0fus (jitter %.0fus), about %.1fms stick to motors (estimated)\n",
+         l.read_to_cmd, l.read_to_cmd_jitter, (unsigned long)l.read_to_cmd_max, l.poll, l.poll_jitter, l.latency / 1000.0);
+}
+
+}  // namespace driver
@@ -0,0 +1,257 @@
+#include "heading.hpp"
+
+#include "main.h"
+
+namespace heading {
+namespace {
+const int DELAY = ez::util::DELAY_TIME;
+const double DT = DELAY / 1000.0;
+const double DISAGREE_ANGLE = 5.0;   // degrees from the fused heading before an IMU is dropped
+const int REJOIN_TIME = 2000;        // ms an IMU has to track the others before it's trusted again
+const double RESET_JUMP = 1.0;       // degrees the primary can move apart from the fused heading in one loop, more is a reset
+const double VARIANCE_FLOOR = 0.01;  // (deg/s)^2, so a perfectly quiet IMU can't take all the weight
+const double ZUPT_SPEED = 0.2;       // in/s, under one encoder tick per loop (about 2.5 in/s), so no tick at all
+const double ZUPT_CURRENT = 400.0;   // mA, more means the drive is pushing on something
+const int ZUPT_TIME = 200;           // ms stopped before bias is learned, skips the wobble of stopping
+const double ZUPT_RATE = 2.0;        // deg/s, faster than any bias so it's a real turn
+const double ZUPT_GAIN = 0.02;       // per loop, about half a second to settle on a new bias
+
+struct imu_state {
+  pros::Imu* imu;
+  double last = 0.0;      // raw rotation last loop
+  double own = 0.0;       // this IMU's corrected heading
+  double bias = 0.0;
+  double scale = 1.0;
+  double variance = 1.0;
+  bool plugged = false;
+  bool healthy = false;
+  int agree_ms = 0;
+};
+
+pros::Mutex mutex;
+pros::Task* task = nullptr;
+std::vector<int> extra_ports;
+std::vector<imu_state> imus;
+double fused = 0.0, fused_rate = 0.0, fused_accel = 0.0;
+bool zupt_enabled = true;
+int still_ms = 0;
+zupt_stats zupt = {};
+
+bool read(imu_state& s, double& value) {
+  value = s.imu->get_rotation();
+  return std::isfinite(value);
+}
+
+// Stationary means the wheels haven't moved and the motors aren't pushing, then any turn the gyros report is bias
+bool stationary_check() {
+  static double last_left = 0.0, last_right = 0.0;
+  double left = chassis.drive_sensor_left();  // Already inches
+  double right = chassis.drive_sensor_right();
+  double moved = std::max(fabs(left - last_left), fabs(right - last_right)) / DT;
+  last_left = left;
+  last_right = right;
+  bool still = moved < ZUPT_SPEED && fabs(chassis.drive_mA_left()) < ZUPT_CURRENT && fabs(chassis.drive_mA_right()) < ZUPT_CURRENT;
+  still_ms = still ? still_ms + DELAY : 0;
+  return zupt_enabled && still_ms >= ZUPT_TIME;
+}
+
+void task_loop() {
+  uint32_t now = pros::millis();
+  int job = monitor::add("Heading", DELAY);
+  while (true) {
+    monitor::begin(job);
+    mutex.take();
+    // Change in heading from every IMU, corrected for its bias and scale
+    std::vector<double> change(imus.size(), 0.0);
+    double primary_raw = 0.0;
+    for (size_t i = 0; i < imus.size(); i++) {
+      imu_state& s = imus[i];
+      double raw;
+      if (!read(s, raw)) {
+        if (s.plugged) LOGW("Heading: IMU on port %i lost", s.imu->get_port());
+        s.plugged = s.healthy = false;
+        continue;
+      }
+      if (i == 0) primary_raw = raw;
+      if (!s.plugged) {
+        s.plugged = true;
+        s.own = fused;
+        s.agree_ms = 0;
+      } else {
+        change[i] = (raw - s.last - s.bias * DT) * s.scale;
+      }
+      s.last = raw;
+    }
+
+    double sum = 0.0, weights = 0.0;
+    for (size_t i = 0; i < imus.size(); i++) {
+      if (!imus[i].healthy) continue;
+      double w = 1.0 / std::max(imus[i].variance, VARIANCE_FLOOR);
+      sum += w * change[i];
+      weights += w;
+    }
+    double fused_change = weights > 0.0 ? sum / weights : 0.0;
+
+    // Acceleration in the floor's plane, averaged over the healthy IMUs so mounting direction doesn't matter
+    double accel_sum = 0.0;
+    int accel_count = 0;
+    for (auto& s : imus) {
+      if (!s.healthy) continue;
+      pros::imu_accel_s_t a = s.imu->get_accel();
+      if (!std::isfinite(a.x) || !std::isfinite(a.y)) continue;
+      accel_sum += hypot(a.x, a.y);
+      accel_count++;
+    }
+    fused_accel = accel_count > 0 ? accel_sum / accel_count : 0.0;
+
+    // Zero velocity update, a still robot isn't turning so what the gyros read is their bias
+    bool still = stationary_check() && fabs(fused_change) < ZUPT_RATE * DT;
+    if (still) {
+      if (!zupt.stationary) zupt.updates++;
+      zupt.stationary_ms += DELAY;
+      zupt.removed += fused_change;
+      for (size_t i = 0; i < imus.size(); i++) {
+        if (imus[i].plugged) imus[i].bias += ZUPT_GAIN * change[i] / (DT * imus[i].scale);
+      }
+      fused_change = 0.0;
+    }
+    zupt.stationary = still;
+
+    if (imus[0].healthy && fabs(change[0] - fused_change) > RESET_JUMP) {
+      // drive_imu_reset() or set_rotation() on the primary, everything follows it
+      fused = primary_raw;
+      for (auto& s : imus) s.own = fused;
+    } else {
+      fused += fused_change;
+      fused_rate = fused_change / DT;
+
+      // Learn each IMU's bias while still and scale while turning fast, relative to the fused heading
+      for (size_t i = 0; i < imus.size(); i++) {
+        imu_state& s = imus[i];
+        if (!s.plugged) continue;
+        double residual = (change[i] - fused_change) / DT;
+        if (still) residual = 0.0;
+        s.variance += 0.01 * (residual * residual - s.variance);
+        if (weights > 0.0 && fabs(fused_rate) < 5.0) s.bias += 0.002 * residual;
+        if (weights > 0.0 && fabs(fused_rate) > 90.0 && fabs(change[i]) > 1e-6) s.scale = std::clamp(s.scale * (1.0 - 0.001 * residual * DT / change[i]), 0.98, 1.02);
+
+        s.own += still ? 0.0 : change[i];
+        if (s.healthy && fabs(s.own - fused) > DISAGREE_ANGLE) {
+          LOGW("Heading: IMU on port %i disagrees by %.1f degrees, dropping it", s.imu->get_port(), s.own - fused);
+          s.healthy = false;
+          s.agree_ms = 0;
+        } else if (!s.healthy) {
+          // Rejoin after tracking the fused heading's changes for a while
+          s.agree_ms = fabs(residual) < 5.0 ? s.agree_ms + DELAY : 0;
+          if (s.agree_ms >= REJOIN_TIME || weights == 0.0) {
+            s.healthy = true;
+            LOGI("Heading: IMU on port %i trusted", s.imu->get_port());
+          }
+        }
+        if (!s.healthy) s.own = fused;
+      }
+
+      // EZ-Template only reads the primary, give it the fused, bias corrected heading
+      if (imus[0].plugged && fabs(primary_raw - fused) > 1e-4) {
+        imus[0].imu->set_rotation(fused);
+        imus[0].last = fused;
+      }
+    }
+    zupt.bias = imus[0].bias;
+    mutex.give();
+
+    monitor::end(job);
+    pros::Task::delay_until(&now, DELAY);
+  }
+}
+}  // namespace
+
+void add(int port) { extra_ports.push_back(abs(port)); }
+
+void initialize() {
+  if (task != nullptr) return;
+  imus.push_back({&chassis.imu});
+  for (int port : extra_ports) {
+    if (imus.size() >= 16) break;
+    imus.push_back({new pros::Imu(port)});
+    imus.back().imu->reset(false);
+  }
+  // Calibration takes about 2 seconds, wait on all of them together
+  for (size_t i = 1; i < imus.size(); i++) {
+    uint32_t start = pros::millis();
+    while (imus[i].imu->is_calibrating() && pros::millis() - start < 3000) pros::delay(DELAY);
+  }
+
+  fused = chassis.imu.get_rotation();
+  if (!std::isfinite(fused)) fused = 0.0;
+  for (auto& s : imus) {
+    double raw;
+    s.plugged = s.healthy = read(s, raw);
+    s.own = s.last = fused;
+    if (s.plugged && &s != &imus[0]) s.imu->set_rotation(fused);
+  }
+  task = new pros::Task(task_loop, jobs::priority(DELAY, jobs::ESTIMATION), TASK_STACK_DEPTH_DEFAULT, "Heading");
+}
+
+double get() {
+  if (task == nullptr) {
+    double raw = chassis.imu.get_rotation();  // Not drive_imu_get(), that has EZ-Template's scaler on it
+    return std::isfinite(raw) ? raw : 0.0;
+  }
+  mutex.take();
+  double copy = fused;
+  mutex.give();
+  return copy;
+}
+
+double rate_get() {
+  mutex.take();
+  double copy = fused_rate;
+  mutex.give();
+  return copy;
+}
+
+double accel_get() {
+  mutex.take();
+  double copy = fused_accel;
+  mutex.give();
+  return copy;
+}
+
+std::vector<imu_status> status_get() {
+  mutex.take();
+  double weights = 0.0;
+  for (auto& s : imus) {
+    if (s.healthy) weights += 1.0 / std::max(s.variance, VARIANCE_FLOOR);
+  }
+  std::vector<imu_status> out;
+  for (auto& s : imus) {
+    double w = s.healthy && weights > 0.0 ? (1.0 / std::max(s.variance, VARIANCE_FLOOR)) / weights : 0.0;
+    out.push_back({s.imu->get_port(), s.healthy, w, s.bias, s.scale, s.variance});
+  }
+  mutex.give();
+  return out;
+}
+
+void zupt_enable(bool enable) {
+  mutex.take();
+  zupt_enabled = enable;
+  mutex.give();
+}
+
+zupt_stats zupt_get() {
+  mutex.take();
+  zupt_stats copy = zupt;
+  mutex.give();
+  return copy;
+}
+
+int healthy_count() {
+  mutex.take();
+  int count = 0;
+  for (auto& s : imus) count += s.healthy;
+  mutex.give();
+  return count;
+}
+
+}  // namespace heading
@@ -0,0 +1,170 @@
+#include "input.hpp"
+
+#include "main.h"
+#include "seqlock.hpp"
+
+namespace input {
+namespace {
+const int BUTTON_COUNT = 12;  // L1 through A, pros::E_CONTROLLER_DIGITAL_L1 is 6
+
+struct binding {
+  std::string action;
+  buttons set;
+  e_trigger trigger;
+  uint32_t hold_time;
+};
+
+constexpr buttons bit(pros::controller_digital_e_t button) { return (buttons)(1 << (button - pros::E_CONTROLLER_DIGITAL_L1)); }
+
+// Everything one update() leaves behind, published whole so the driver task never sees half of it
+typedef struct state {
+  snapshot now, last;
+  uint32_t press_time[BUTTON_COUNT];  // ms each button last went down
+} state;
+
+state working = {};  // only update() touches this
+seqlock<state> published;
+
+// bind() can grow the table while another task is looking through it
+pros::Mutex table_mutex;
+
+// The controls opcontrol() has always had
+std::vector<binding> table = {
+    {"pid_tuner", bit(pros::E_CONTROLLER_DIGITAL_X), PRESS, 0},
+    {"run_auton", bit(pros::E_CONTROLLER_DIGITAL_UP) | bit(pros::E_CONTROLLER_DIGITAL_LEFT), PRESS, 0},
+    {"assist_bypass", bit(pros::E_CONTROLLER_DIGITAL_RIGHT), HELD, 0},  // Not UP, holding it would start the run_auton chord
+    {"quick_turn", bit(pros::E_CONTROLLER_DIGITAL_Y), HELD, 0},
+    {"intake", bit(pros::E_CONTROLLER_DIGITAL_R2), HELD, 0},
+    {"outtake", bit(pros::E_CONTROLLER_DIGITAL_R1), HELD, 0},
+    {"ladybrown_up", bit(pros::E_CONTROLLER_DIGITAL_L1), HELD, 0},
+    {"ladybrown_down", bit(pros::E_CONTROLLER_DIGITAL_L2), HELD, 0},
+    {"ladybrown_next", bit(pros::E_CONTROLLER_DIGITAL_DOWN), PRESS, 0},
+    {"ladybrown_score", bit(pros::E_CONTROLLER_DIGITAL_DOWN), HELD, 0},
+    {"clamp", bit(pros::E_CONTROLLER_DIGITAL_B), PRESS, 0},
+    {"rush", bit(pros::E_CONTROLLER_DIGITAL_A), PRESS, 0},
+    // Joystick curves, see assist::curves_iterate().  Unbound, every button is taken
+    {"curve_left_down", 0, PRESS, 0},
+    {"curve_left_up", 0, PRESS, 0},
+    {"curve_right_down", 0, PRESS, 0},
+    {"curve_right_up", 0, PRESS, 0},
+};
+
+// When the last button of a fully held set went down
+uint32_t chord_start(const state& s, buttons set) {
+  uint32_t start = 0;
+  for (int i = 0; i < BUTTON_COUNT; i++) {
+    if (set & (1 << i)) start = std::max(start, s.press_time[i]);
+  }
+  return start;
+}
+
+bool held(const state& s, buttons set) { return set != 0 && (s.now.held & set) == set; }
+
+bool pressed(const state& s, buttons set) { return held(s, set) && (s.last.held & set) != set; }
+
+bool released(const state& s, buttons set) { return set != 0 && (s.last.held & set) == set && (s.now.held & set) != set; }
+
+binding* find(const std::string& action) {
+  for (auto& b : table) {
+    if (b.action == action) return &b;
+  }
+  return nullptr;
+}
+}  // namespace
+
+buttons mask(std::initializer_list<pros::controller_digital_e_t> list) {
+  buttons set = 0;
+  for (auto button : list) set |= bit(button);
+  return set;
+}
+
+void update() {
+  snapshot& now = working.now;
+  working.last = now;
+  now.time = pros::millis();
+  now.held = 0;
+  for (int i = 0; i < BUTTON_COUNT; i++) {
+    if (master.get_digital((pros::controller_digital_e_t)(pros::E_CONTROLLER_DIGITAL_L1 + i))) now.held |= 1 << i;
+  }
+  now.pressed = now.held & ~working.last.held;
+  now.released = working.last.held & ~now.held;
+  for (int i = 0; i < BUTTON_COUNT; i++) {
+    if (now.pressed & (1 << i)) working.press_time[i] = now.time;
+  }
+  now.time_us = pros::micros();
+  for (int i = 0; i < 4; i++) {
+    now.analog[i] = std::clamp(master.get_analog((pros::controller_analog_e_t)i), -127, 127);
+  }
+  published.set(working);
+}
+
+snapshot get() { return published.get().now; }
+
+bool held(buttons set) { return held(published.get(), set); }
+
+bool pressed(buttons set) { return pressed(published.get(), set); }
+
+bool released(buttons set) { return released(published.get(), set); }
+
+uint32_t held_time(buttons set) {
+  state s = published.get();
+  return held(s, set) ? s.now.time - chord_start(s, set) : 0;
+}
+
+int analog(pros::controller_analog_e_t channel) { return published.get().now.analog[channel]; }
+
+void bind(const std::string& action, buttons set, e_trigger trigger, uint32_t hold_time) {
+  table_mutex.take();
+  binding* b = find(action);
+  if (b == nullptr) {
+    table.push_back({action, set, trigger, hold_time});
+  } else {
+    *b = {action, set, trigger, hold_time};
+  }
+  table_mutex.give();
+}
+
+bool action(const std::string& action) {
+  // Copy the binding out, the table can change once the mutex is given back
+  table_mutex.take();
+  binding* b = find(action);
+  buttons set = b != nullptr ? b->set : 0;  // Unbound, never fires
+  e_trigger trigger = b != nullptr ? b->trigger : HELD;
+  uint32_t hold_time = b != nullptr ? b->hold_time : 0;
+  table_mutex.give();
+
+  state s = published.get();
+  switch (trigger) {
+    case HELD:
+      return held(s, set);
+    case PRESS:
+      return pressed(s, set);
+    case RELEASE:
+      return released(s, set);
+    case LONG_HOLD: {
+      if (!held(s, set)) return false;
+      uint32_t start = chord_start(s, set);
+      bool was_long = (s.last.held & set) == set && s.last.time - start >= hold_time;
+      return s.now.time - start >= hold_time && !was_long;
+    }
+  }
+  return false;
+}
+
+void bindings_print() {
+  const char* names[BUTTON_COUNT] = {"L1", "L2", "R1", "R2", "UP", "DOWN", "LEFT", "RIGHT", "X", "B", "Y", "A"};
+  const char* triggers[] = {"held", "press", "release", "long hold"};
+  table_mutex.take();
+  for (auto& b : table) {
+    std::string keys;
+    for (int i = 0; i < BUTTON_COUNT; i++) {
+      if (!(b.set & (1 << i))) continue;
+      if (!keys.empty()) keys += "+";
+      keys += names[i];
+    }
+    printf("%-16s %-12s %s\n", b.action.c_str(), keys.empty() ? "-" : keys.c_str(), triggers[b.trigger]);
+  }
+  table_mutex.give();
+}
+
+}  // namespace input
@@ -0,0 +1,63 @@
+#include "jobs.hpp"
+
+#include "main.h"
+
+namespace jobs {
+namespace {
+struct job {
+  std::string name;
+  uint32_t period_ms;
+  e_criticality criticality;
+  uint32_t priority;
+  std::function<void()> run;
+  pros::Task* task;
+};
+
+pros::Mutex mutex;
+std::vector<job*> list;
+
+void job_loop(job* j) {
+  int id = monitor::add(j->name, j->period_ms);
+  uint32_t now = pros::millis();
+  while (true) {
+    monitor::begin(id);
+    j->run();
+    monitor::end(id);
+    pros::Task::delay_until(&now, j->period_ms);
+  }
+}
+}  // namespace
+
+uint32_t priority(uint32_t period_ms, e_criticality criticality) {
+  // Faster loops get up to 3 levels more within their band.  The bands don't overlap, so the slowest
+  // control loop still beats the fastest estimator
+  int rate = period_ms <= 5 ? 3 : period_ms <= 10 ? 2 : period_ms <= 25 ? 1 : 0;
+  switch (criticality) {
+    case CONTROL:
+      return TASK_PRIORITY_DEFAULT + 5 + rate;  // 13 to 16
+    case ESTIMATION:
+      return TASK_PRIORITY_DEFAULT + 1 + rate;  // 9 to 12, above opcontrol() and EZ-Template
+    case ODOMETRY:
+      return TASK_PRIORITY_DEFAULT - 1;  // EZ-Template's odometry can't be partway through an update when this runs
+    case UI:
+    default:
+      return std::min<uint32_t>(TASK_PRIORITY_MIN + 1 + rate, TASK_PRIORITY_DEFAULT - 2);  // Below everything that moves the robot, and ODOMETRY
+  }
+}
+
+void add(const std::string& name, uint32_t period_ms, e_criticality criticality, std::function<void()> run) {
+  job* j = new job{name, period_ms, criticality, priority(period_ms, criticality), run, nullptr};
+  mutex.take();
+  list.push_back(j);
+  mutex.give();
+  j->task = new pros::Task([j]() { job_loop(j); }, j->priority, TASK_STACK_DEPTH_DEFAULT, j->name.c_str());
+}
+
+void print() {
+  const char* names[] = {"control", "estimation", "odometry", "ui"};
+  mutex.take();
+  for (auto j : list) printf("%-16s %4lums  %-10s priority %lu\n", j->name.c_str(), (unsigned long)j->period_ms, names[j->criticality], (unsigned long)j->priority);
+  mutex.give();
+}
+
+}  // namespace jobs
@@ -0,0 +1,192 @@
+#include "localize.hpp"
+
+#include "main.h"
+
+namespace localize {
+namespace {
+const int DELAY = 50;               // ms, the distance sensors update about this often
+const double MM_PER_IN = 25.4;
+const double TRUSTED_SPREAD = 4.0;  // inches, particles have to agree this well before odometry is corrected
+const double STEP_MAX = 2.0;        // inches, most odometry is moved per update
+const double JUMP = 12.0;           // inches, more than this between updates and odometry was set, not driven
+
+typedef struct sensor {
+  pros::Distance* device;
+  int id;  // in the sensor hub
+} sensor;
+
+pros::Mutex mutex;
+pros::Task* task = nullptr;
+std::vector<sensor> devices;
+std::vector<mcl::mount> mounts;
+mcl::filter* particles = nullptr;
+mcl::pose origin = {0, 0, 0};  // Where odometry's (0, 0) is on the field, and which way its 0 degrees faces
+mcl::pose estimate = {0, 0, 0};
+bool correcting = true;
+double correction_gain = 0.2;
+stats_t stats = {0, 0, 0, 0, 0, 0.0, 0.0, 0};
+
+// Both frames measure theta clockwise from +y, so turning a vector by phi is the same rotation either way
+mcl::pose to_field(const ez::pose& p) {
+  double phi = ez::util::to_rad(origin.theta);
+  return {origin.x + p.x * cos(phi) + p.y * sin(phi), origin.y - p.x * sin(phi) + p.y * cos(phi), origin.theta + p.theta};
+}
+
+ez::pose to_odom(const mcl::pose& p) {
+  double phi = ez::util::to_rad(origin.theta);
+  double x = p.x - origin.x, y = p.y - origin.y;
+  return {x * cos(phi) - y * sin(phi), x * sin(phi) + y * cos(phi), p.theta - origin.theta};
+}
+
+double reading(const sensor& s, const mcl::mount& m) {
+  double mm = sensors::value(s.id);
+  if (mm <= 0.0 || mm >= 9999.0 || mm == PROS_ERR) return -1.0;  // 9999 is nothing in range
+  double inches = mm / MM_PER_IN;
+  return inches < m.max_range ? inches : -1.0;
+}
+
+void task_loop() {
+  ez::pose last = chassis.odom_pose_get();
+  std::vector<double> ranges(devices.size());
+
+  uint32_t now = pros::millis();
+  int job = monitor::add("Localize", DELAY);
+  while (true) {
+    monitor::begin(job);
+    // Corrections write the pose back, so this reads EZ-Template's own copy rather than the published one (tracking.hpp)
+    ez::pose odom = chassis.odom_pose_get();
+    double dx = odom.x - last.x, dy = odom.y - last.y, turned = odom.theta - last.theta;
+
+    mutex.take();
+    uint32_t start = pros::micros();
+    if (hypot(dx, dy) > JUMP || fabs(turned) > 45.0) {
+      // An auton set the pose, so odometry is right about where it is for now
+      particles->reset(to_field(odom), 2.0, 2.0);
+      stats.resets++;
+    } else {
+      // Motion in the robot's frame is the same in both frames
+      double mid = ez::util::to_rad(last.theta + turned / 2.0);
+      particles->predict(dx * sin(mid) + dy * cos(mid), dx * cos(mid) - dy * sin(mid), turned);
+      int used = 0;
+      for (size_t i = 0; i < devices.size(); i++) {
+        ranges[i] = reading(devices[i], mounts[i]);
+        used += ranges[i] > 0.0;
+      }
+      particles->update(ranges.data());
+      stats.readings = used;
+    }
+    estimate = particles->estimate();
+    estimate.theta = origin.theta + odom.theta;  // The IMU knows heading better than the walls do
+    stats.spread = particles->spread();
+    stats.ess = particles->ess();
+
+    // Nudge odometry toward the particles, and move last with it so the filter doesn't see its own correction as driving
+    if (correcting && stats.spread < TRUSTED_SPREAD) {
+      ez::pose target = to_odom(estimate);
+      double sx = correction_gain * (target.x - odom.x), sy = correction_gain * (target.y - odom.y);
+      double size = hypot(sx, sy);
+      if (size > STEP_MAX) {
+        sx *= STEP_MAX / size;
+        sy *= STEP_MAX / size;
+      }
+      if (size > 0.05) {
+        odom.x += sx;
+        odom.y += sy;
+        chassis.odom_xy_set(odom.x, odom.y);
+        stats.corrections++;
+      }
+    }
+    last = odom;
+
+    stats.last_us = pros::micros() - start;
+    stats.max_us = std::max(stats.max_us, stats.last_us);
+    stats.updates++;
+    mutex.give();
+
+    monitor::end(job);
+    pros::Task::delay_until(&now, DELAY);
+  }
+}
+}  // namespace
+
+void sensor_add(int port, double x, double y, double theta, double max_range) {
+  if (task != nullptr) {
+    LOGW("Localize: add sensor %i before initialize()", port);
+    return;
+  }
+  pros::Distance* device = new pros::Distance(port);
+  int id = sensors::add("distance_" + std::to_string(port), [device]() { return (double)device->get(); });
+  devices.push_back({device, id});
+  mounts.push_back({x, y, theta, max_range});
+}
+
+void initialize() {
+  if (task != nullptr) return;
+  if (devices.empty()) {
+    LOGW("Localize: no distance sensors");
+    return;
+  }
+  particles = new mcl::filter(mcl::field_map::high_stakes(), mounts, mcl::constants_t(), pros::micros() + 1);
+  particles->reset(to_field(chassis.odom_pose_get()), 2.0, 2.0);
+  // Below EZ-Template's task so its odometry update is never half done when this writes the pose, see tracking.hpp
+  task = new pros::Task(task_loop, jobs::priority(DELAY, jobs::ODOMETRY), TASK_STACK_DEPTH_DEFAULT, "Localize");
+}
+
+void start_set(mcl::pose field_pose) {
+  ez::pose odom = chassis.odom_pose_get();
+  mutex.take();
+  // Solve for the origin that puts the current odometry pose at field_pose
+  origin.theta = field_pose.theta - odom.theta;
+  double phi = ez::util::to_rad(origin.theta);
+  origin.x = field_pose.x - (odom.x * cos(phi) + odom.y * sin(phi));
+  origin.y = field_pose.y - (-odom.x * sin(phi) + odom.y * cos(phi));
+  if (particles != nullptr) particles->reset(field_pose, 1.0, 1.0);
+  estimate = field_pose;
+  mutex.give();
+}
+
+void relocalize() {
+  ez::pose odom = chassis.odom_pose_get();
+  mutex.take();
+  if (particles != nullptr) particles->reset_global(origin.theta + odom.theta);
+  mutex.give();
+}
+
+void correction_set(bool enabled, double gain) {
+  mutex.take();
+  correcting = enabled;
+  correction_gain = std::clamp(gain, 0.0, 1.0);
+  mutex.give();
+}
+
+mcl::pose field_get() {
+  mutex.take();
+  mcl::pose copy = estimate;
+  mutex.give();
+  return copy;
+}
+
+ez::pose odom_get() {
+  mutex.take();
+  ez::pose copy = to_odom(estimate);
+  mutex.give();
+  return copy;
+}
+
+stats_t stats_get() {
+  mutex.take();
+  stats_t copy = stats;
+  mutex.give();
+  return copy;
+}
+
+void print() {
+  mcl::pose p = field_get();
+  stats_t s = stats_get();
+  printf("Localize: (%.1f, %.1f, %.1f) spread %.1fin, %i of %i sensors reading, %i particles effective\n", p.x, p.y, p.theta, s.spread,
+         s.readings, (int)devices.size(), (int)s.ess);
+  printf("  %lu updates, %lu corrections, %lu resets, %luus last, %luus max\n", (unsigned long)s.updates, (unsigned long)s.corrections,
+         (unsigned long)s.resets, (unsigned long)s.last_us, (unsigned long)s.max_us);
+}
+
+}  // namespace localize
@@ -0,0 +1,229 @@
+#include "logging.hpp"
+
+#include "main.h"
+
+namespace logging {
+namespace {
+const uint32_t PERIOD = 20;  // ms between drains
+const int QUEUE_SIZE = 64;   // records, about a second of heavy logging
+
+typedef struct queued {
+  site* from;
+  uint32_t time;
+  uint8_t length;
+  uint8_t args[RECORD_MAX];
+} queued;
+
+// A binary or text output
+typedef struct sink {
+  e_level level;
+  bool binary;
+  FILE* file;
+  uint8_t seq;
+  std::vector<bool> announced;  // by site id, formats this sink has been sent
+} sink;
+
+pros::Mutex mutex;
+pros::Task* task = nullptr;
+queued queue[QUEUE_SIZE];
+int head = 0, count = 0;
+uint32_t lost = 0;
+stats_t stats = {};
+
+// Only the logging task touches sinks outside of the setters, which take drain_mutex
+pros::Mutex drain_mutex;
+sink terminal = {INFO, false, stdout, 0, {}};
+sink sd = {OFF, true, nullptr, 0, {}};
+e_level screen_level = WARN;
+
+void lowest_update() {
+  uint8_t level = std::min({terminal.level, sd.file != nullptr ? sd.level : OFF, screen_level});
+  lowest = level;
+}
+
+void frame_send(sink& out, telemetry::frame_writer& frame) {
+  uint8_t encoded[telemetry::ENCODED_MAX];
+  size_t length = telemetry::frame_finish(frame, encoded);
+  if (length == 0) return;
+  fwrite(encoded, 1, length, out.file);
+  if (&out == &sd) stats.sd_bytes += length;
+}
+
+void format_send(sink& out, const site& s) {
+  if (s.id < (int)out.announced.size() && out.announced[s.id]) return;
+  if (s.id >= (int)out.announced.size()) out.announced.resize(s.id + 1, false);
+  out.announced[s.id] = true;
+
+  const char* file = strrchr(s.file, '/');
+  uint8_t buffer[telemetry::FRAME_MAX];
+  telemetry::frame_writer frame(buffer, sizeof(buffer));
+  frame.u8(FRAME_FORMAT);
+  frame.u8(out.seq++);
+  frame.varint(s.id);
+  frame.u8(s.level);
+  frame.varint(s.line);
+  string_write(frame, file != nullptr ? file + 1 : s.file, 64);
+  string_write(frame, s.format, telemetry::FRAME_MAX - 80);
+  frame_send(out, frame);
+}
+
+void record_send(sink& out, const queued& r) {
+  format_send(out, *r.from);
+  uint8_t buffer[telemetry::FRAME_MAX];
+  telemetry::frame_writer frame(buffer, sizeof(buffer));
+  frame.u8(FRAME_RECORD);
+  frame.u8(out.seq++);
+  frame.varint(r.from->id);
+  frame.varint(r.time);
+  for (int i = 0; i < r.length; i++) frame.u8(r.args[i]);
+  frame_send(out, frame);
+}
+
+void lost_send(sink& out, uint32_t records) {
+  uint8_t buffer[16];
+  telemetry::frame_writer frame(buffer, sizeof(buffer));
+  frame.u8(FRAME_LOST);
+  frame.u8(out.seq++);
+  frame.varint(records);
+  frame_send(out, frame);
+}
+
+void drain() {
+  static queued batch[QUEUE_SIZE];
+  mutex.take();
+  int n = count;
+  for (int i = 0; i < n; i++) batch[i] = queue[(head + i) % QUEUE_SIZE];
+  head = (head + n) % QUEUE_SIZE;
+  count = 0;
+  uint32_t dropped = lost;
+  lost = 0;
+  mutex.give();
+  if (n == 0 && dropped == 0) return;
+
+  drain_mutex.take();
+  sink* outputs[] = {&terminal, &sd};
+  std::string text, screen_text;
+  e_level shown = OFF;
+  for (int i = 0; i < n; i++) {
+    const queued& r = batch[i];
+    e_level level = r.from->level;
+    bool rendered = false;
+    auto line = [&]() -> const std::string& {
+      if (!rendered) {
+        telemetry::frame_reader args(r.args, r.length);
+        text = render(r.from->format, args);
+        rendered = true;
+      }
+      return text;
+    };
+    for (sink* out : outputs) {
+      if (out->file == nullptr || level < out->level) continue;
+      if (out->binary)
+        record_send(*out, r);
+      else if (level == INFO)
+        printf("%s\n", line().c_str());
+      else
+        printf("%s: %s\n", level_name(level), line().c_str());
+    }
+    if (level >= screen_level) {
+      screen_text = line();
+      shown = level;
+    }
+  }
+  if (shown != OFF) dashboard::message_set(screen_text, shown >= ERROR ? 0xFF4040 : shown >= WARN ? 0xFFD000 : 0xFFFFFF);
+  if (dropped > 0) {
+    for (sink* out : outputs) {
+      if (out->file == nullptr || out->level == OFF) continue;
+      if (out->binary)
+        lost_send(*out, dropped);
+      else
+        printf("Log: %lu records dropped\n", (unsigned long)dropped);
+    }
+  }
+  fflush(stdout);
+  if (sd.file != nullptr) fflush(sd.file);
+  drain_mutex.give();
+}
+
+void task_loop() {
+  int job = monitor::add("Log", PERIOD);
+  uint32_t now = pros::millis();
+  while (true) {
+    monitor::begin(job);
+    drain();
+    monitor::end(job);
+    pros::Task::delay_until(&now, PERIOD);
+  }
+}
+}  // namespace
+
+void submit(site& s, const char* format, const uint8_t* args, size_t length, bool ok) {
+  mutex.take();
+  if (s.id < 0) {
+    s.format = format;
+    s.id = stats.sites++;
+  }
+  if (count == QUEUE_SIZE) {
+    lost++;
+    stats.dropped++;
+  } else {
+    queued& r = queue[(head + count++) % QUEUE_SIZE];
+    r.from = &s;
+    r.time = pros::millis();
+    r.length = ok ? length : 0;  // Arguments that didn't fit are left off, the decoder shows the format alone
+    memcpy(r.args, args, r.length);
+    stats.records++;
+  }
+  if (task == nullptr) task = new pros::Task(task_loop, jobs::priority(PERIOD, jobs::UI), TASK_STACK_DEPTH_DEFAULT, "Log");
+  mutex.give();
+}
+
+void terminal_set(e_level level, bool binary) {
+  drain_mutex.take();
+  terminal.level = level;
+  if (binary != terminal.binary) terminal.announced.clear();
+  terminal.binary = binary;
+  lowest_update();
+  drain_mutex.give();
+}
+
+bool sd_start(e_level level, const std::string& path) {
+  drain_mutex.take();
+  if (sd.file != nullptr) fclose(sd.file);
+  sd.file = fopen(path.c_str(), "wb");
+  sd.level = level;
+  sd.seq = 0;
+  sd.announced.clear();
+  lowest_update();
+  bool ok = sd.file != nullptr;
+  drain_mutex.give();
+  if (!ok) LOGW("Log: couldn't open %s", path);
+  return ok;
+}
+
+void sd_stop() {
+  drain_mutex.take();
+  if (sd.file != nullptr) fclose(sd.file);
+  sd.file = nullptr;
+  lowest_update();
+  drain_mutex.give();
+}
+
+void screen_set(e_level level) {
+  drain_mutex.take();
+  screen_level = level;
+  lowest_update();
+  drain_mutex.give();
+}
+
+stats_t stats_get() {
+  mutex.take();
+  stats_t copy = stats;
+  mutex.give();
+  drain_mutex.take();
+  copy.sd_bytes = stats.sd_bytes;
+  drain_mutex.give();
+  return copy;
+}
+
+}  // namespace logging
@@ -17,13 +17,32 @@ ez::Drive chassis(
 //ez::tracking_wheel horiz_tracker(13, 2, 4.0);  // This tracking wheel is perpendicular to the drive wheels
 
 void on_center_button() { // Toggle the clamp
-  if (clampstate == 0) { // If the clamp is open//
+  if (clamp_state.latest() == 0) { // If the clamp is open//
     set_clamp(2); // Close the clamp
   } else {
     set_clamp(0); // Open the clamp
   }
 }
 
+// Checks every port the robot uses and reports anything that isn't plugged in
+void devices_check() {
+  std::vector<std::pair<int, pros::DeviceType>> expected;
+  for (auto& motor : chassis.left_motors) expected.push_back({motor.get_port(), pros::DeviceType::motor});
+  for (auto& motor : chassis.right_motors) expected.push_back({motor.get_port(), pros::DeviceType::motor});
+  for (auto port : ladybrown.get_port_all()) expected.push_back({port, pros::DeviceType::motor});
+  expected.push_back({inveyor.get_port(), pros::DeviceType::motor});
+  expected.push_back({chassis.imu.get_port(), pros::DeviceType::imu});
+
+  std::string missing = "";
+  for (auto& [port, type] : expected) {
+    if (pros::Device::get_plugged_type(abs(port)) != type) missing += std::to_string(abs(port)) + " ";
+  }
+  if (missing != "") {
+    LOGE("Missing devices on ports: %s", missing);
+    master.set_text(1, 0, ("Port " + missing).substr(0, 15));
+  }
+}
+
 #pragma region Initialize
 /**
  * Runs initialization code. This occurs as soon as the program is started.
@@ -35,19 +54,20 @@ void initialize() {
   // Print our branding over your terminal :D
   ez::ez_template_print();
 
-  pros::delay(500);  // Stop the user from doing anything while legacy ports configure
-
   // Configure your chassis controls
-  chassis.opcontrol_curve_buttons_toggle(true);  // Enables modifying the controller curve with buttons on the joysticks
+  chassis.opcontrol_curve_buttons_toggle(false);  // Curves are changed through input.hpp's bindings instead, see assist::curves_iterate()
   chassis.opcontrol_drive_activebrake_set(0);    // Sets the active brake kP. We recommend ~2.  0 will disable.
   chassis.opcontrol_curve_default_set(0, 0);     // Defaults for curve. If using tank, only the first parameter is used. (Comment this line out if you have an SD card!)
 
   // Set the drive to your own constants from autons.cpp!
   default_constants();
 
-  // These are already defaulted to these buttons, but you can change the left/right curve buttons here!
-  // chassis.opcontrol_curve_buttons_left_set(pros::E_CONTROLLER_DIGITAL_LEFT, pros::E_CONTROLLER_DIGITAL_RIGHT);  // If using tank, only the left side is used.
-  // chassis.opcontrol_curve_buttons_right_set(pros::E_CONTROLLER_DIGITAL_Y, pros::E_CONTROLLER_DIGITAL_A);
+  // Every button is taken, so the curve bindings are empty.  Give them buttons here to tune curves from the controller
+  //  Y is quick_turn with curvature drive, move one of them if you drive that way
+  // input::bind("curve_left_down", input::mask({pros::E_CONTROLLER_DIGITAL_LEFT}), input::PRESS);  // If using tank, only the left side is used.
+  // input::bind("curve_left_up", input::mask({pros::E_CONTROLLER_DIGITAL_RIGHT}), input::PRESS);
+  // input::bind("curve_right_down", input::mask({pros::E_CONTROLLER_DIGITAL_Y}), input::PRESS);
+  // input::bind("curve_right_up", input::mask({pros::E_CONTROLLER_DIGITAL_A}), input::PRESS);
 
   // Autonomous Selector using LLEMU
   ez::as::auton_selector.autons_add({
@@ -68,13 +88,57 @@ void initialize() {
 
   });
 
-  // Initialize chassis and auton selector
-  chassis.initialize();
-  ez::as::initialize();
-  master.rumble(".");
-
   // Initialize device properties
   ladybrown.set_brake_mode_all(MOTOR_BRAKE_HOLD);
+
+  // Startup runs as stages in parallel so initialize() returns right away
+  //  autonomous() and opcontrol() wait for only the stages they need with boot::wait()
+  boot::stage_add("adi", []() { pros::delay(500); });  // Legacy ports need time to configure before they're used
+  boot::stage_add("sensors", []() {
+    sensors::initialize();  // Reads the legacy ports, so waits for them
+    arm::initialize();      // Lady Brown angle from the pot and motor encoders
+  }, {"adi"});
+  boot::stage_add("mechanisms", []() { mechanisms_initialize(); }, {"sensors"});  // The Lady Brown job uses the arm estimate
+  boot::stage_add("imu", []() {
+    chassis.drive_imu_calibrate(false);  // No loading animation, the auton selector owns the screen
+    chassis.drive_sensor_reset();
+    // heading::add(5);  // Extra IMUs are fused with the chassis IMU and take over if it fails
+    heading::initialize();
+    tracking::initialize();  // Whole pose snapshots for every other task
+  });
+  boot::stage_add("config", []() {
+    config::load();  // Tuned constants and curves saved from the PID tuner and assist::curves_iterate() replace the defaults
+  });
+  boot::stage_add("selector", []() { ez::as::initialize(); }, {"config"});  // Waits so the SD card is read one stage at a time
+  boot::stage_add("devices", devices_check);
+  boot::stage_add("dashboard", []() { dashboard::initialize(); }, {"selector"});  // Built after LLEMU so hide() returns to the selector
+  boot::stage_add("slip", []() { slip::initialize(); }, {"imu"});  // Compares against the IMU, so it needs to be calibrated
+  boot::stage_add("telemetry", []() {
+    telemetry::initialize();
+    // telemetry::start(21);  // Stream over a serial adapter on port 21, read it with tools/telemetry_decode
+    // telemetry::start();    // Stream over the USB terminal instead
+  });
+  boot::stage_add("logging", []() {
+    logging::screen_set(logging::WARN);             // Warnings and errors under the motor bars on the dashboard
+    // logging::sd_start();                         // Log to the SD card too, read it with tools/log_decode
+    // logging::terminal_set(logging::INFO, true);  // Binary on the USB terminal, for tools/log_decode
+  });
+  boot::stage_add("monitor", []() {
+    monitor::initialize();
+    monitor::watch("EZ auto", (pros::task_t)chassis.ez_auto);  // EZ-Template's PID and odometry task
+    // monitor::log_start();  // Append task timing to the SD card once a second
+    // monitor::show();       // Task timing on the brain instead of the auton selector
+  });
+  boot::stage_add("localize", []() {
+    // localize::sensor_add(6, 0.0, 6.0, 0.0);     // Distance sensors facing the walls, inches right and forward of center
+    // localize::sensor_add(7, -6.0, 0.0, -90.0);
+    localize::initialize();  // Does nothing until sensors are added
+  }, {"sensors", "imu"});
+  boot::stage_add("ready", []() {
+    master.rumble(".");
+    boot::timeline_print();
+  }, {"adi", "sensors", "mechanisms", "imu", "config", "selector", "devices", "dashboard", "slip", "telemetry", "logging", "monitor", "localize"});
+  boot::start();
 }
 #pragma endregion
 #pragma region Disabled
@@ -114,10 +178,15 @@ void competition_initialize() {
  * from where it left off.
  */
 void autonomous() {
+  boot::wait({"adi", "imu", "config", "selector"});  // Calibrated IMU, tuned constants and the selected auton
+
   chassis.pid_targets_reset();                // Resets PID targets to 0
   chassis.drive_imu_reset();                  // Reset gyro position to 0
   chassis.drive_sensor_reset();               // Reset drive sensors to 0
   chassis.drive_brake_set(MOTOR_BRAKE_HOLD);  // Set motors to hold.  This helps autonomous consistency
+  slip::clear();                              // Only report slips and collisions from this run
+
+  if (pros::competition::is_connected()) dashboard::show();  // The auton selector isn't needed once a match starts
 
   ez::as::auton_selector.selected_auton_call();  // Calls selected auton from autonomous selector
 }
@@ -141,8 +210,26 @@ void opcontrol() {
   pros::motor_brake_mode_e_t driver_preference_brake = MOTOR_BRAKE_COAST;
 
   chassis.drive_brake_set(driver_preference_brake);
+  motion::cancel();  // A motion left over from autonomous would keep driving
+  motors::invalidate();  // Autonomous moved the motors itself, resend everything
+  assist::reset();
+
+  boot::wait({"mechanisms"});  // Driving doesn't need the IMU, only the legacy ports and the mechanism jobs
+
+  if (pros::competition::is_connected()) dashboard::show();  // The auton selector isn't needed once a match starts
 
+  // The drive runs in its own faster task that reads the sticks right before the motors, see driver.hpp
+  //  To drive from this loop instead, comment this out and uncomment one of the options below
+  driver::start(ez::SPLIT);  // Split arcade with traction and anti-tip limits, hold RIGHT to bypass them
+  // driver::start(ez::SPLIT, true);  // Split curvature drive with the same limits, hold Y to turn in place
+
+  int job = monitor::add("Driver", ez::util::DELAY_TIME);
   while (true) {
+    monitor::begin(job);
+    input::update();    // Read the controller once, everything below uses this loop's snapshot
+    sensors::update();  // Same for every registered sensor, arm::pct_get() included
+    assist::curves_iterate();  // Joystick curves from the controller, here rather than in the driver task since it saves to the SD card
+
     // PID Tuner
     // After you find values that you're happy with, you'll have to set them in auton.cpp
     if (!pros::competition::is_connected()) {
@@ -150,89 +237,53 @@ void opcontrol() {
       //  When enabled:
       //  * use A and Y to increment / decrement the constants
       //  * use the arrow keys to navigate the constants
-      if (master.get_digital_new_press(DIGITAL_X))
+      if (input::action("pid_tuner")) {
         chassis.pid_tuner_toggle();
+        if (!chassis.pid_tuner_enabled()) config::save_async();  // Keep whatever was tuned for the next power on
+      }
 
       // Trigger the selected autonomous routine
-      if (master.get_digital(DIGITAL_UP) && master.get_digital(DIGITAL_LEFT)) {
+      if (input::action("run_auton")) {
+        bool driver_task = driver::running();
+        driver::stop();  // Don't fight the auton for the drive
         autonomous();
         chassis.drive_brake_set(driver_preference_brake);
+        motors::invalidate();
+        if (driver_task) driver::resume();
       }
 
       chassis.pid_tuner_iterate();  // Allow PID Tuner to iterate
     }
     
     // chassis.opcontrol_tank();  // Tank control
-    chassis.opcontrol_arcade_standard(ez::SPLIT);   // Standard split arcade
+    // chassis.opcontrol_arcade_standard(ez::SPLIT);   // Standard split arcade
+    // assist::arcade(ez::SPLIT);  // Split arcade with traction and anti-tip limits, hold RIGHT to bypass them
+    // assist::curvature(ez::SPLIT);  // Split curvature drive with the same limits, hold Y to turn in place
     // chassis.opcontrol_arcade_standard(ez::SINGLE);  // Standard single arcade
     // chassis.opcontrol_arcade_flipped(ez::SPLIT);    // Flipped split arcade
     // chassis.opcontrol_arcade_flipped(ez::SINGLE);   // Flipped single arcade
 
-    if (1==0) {
-      pros::lcd::print(0, "Efficiency: %d", inveyor.get_efficiency());
-    }
-
-    if (master.get_digital(DIGITAL_R2)) {
-      inveyor.move_velocity(600);
-    } else if (master.get_digital(DIGITAL_R1)) {
-      inveyor.move_velocity(-600);
+    if (input::action("intake")) {
+      motors::move_velocity(INVEYOR_MOTOR, 600);
+    } else if (input::action("outtake")) {
+      motors::move_velocity(INVEYOR_MOTOR, -600);
     } else {
-      inveyor.move_velocity(0);
+      motors::move_velocity(INVEYOR_MOTOR, 0);
     }
 
-    if (master.get_digital(DIGITAL_L1)) {
-      if (ldb_pct() < MAX_ANGLE) {
-        ladystate = -1;
-        ladybrown.move_velocity(LDB_SPEED);
-      } else {
-        ladybrown.brake();
-      }
-    } else if (master.get_digital(DIGITAL_L2)) {
-      if (ldb_pct() > MIN_ANGLE) {
-        ladystate = -1;
-        ladybrown.move_velocity(-1*LDB_SPEED);
-      } else {
-        ladybrown.brake();
-      }
-    } else {
-      if (ladystate == 0 and ldb_pct() > MIN_ANGLE) {
-          ladybrown.move_velocity(-1*LDB_SPEED);
-      } else if (ladystate == 1 and ldb_pct() < LOAD_ANGLE) {
-        ladybrown.move_velocity(50);
-      } else if (ladystate == 2) {
-        if (master.get_digital(DIGITAL_DOWN)) {
-          if (ldb_pct() < MAX_ANGLE) {
-            ladybrown.move_velocity(LDB_SPEED);
-          } else {
-            ladybrown.brake();
-          }
-        } else {
-          ladystate = 0;
-        }
-      } else {
-        ladybrown.brake();
-      }
-    }
+    // The Lady Brown job does the rest, see subsystems.cpp
+    int manual = input::action("ladybrown_up") ? 1 : input::action("ladybrown_down") ? -1 : 0;
+    ladybrown_command.send({manual, input::action("ladybrown_next"), input::action("ladybrown_score")});
 
-    if (master.get_digital_new_press(DIGITAL_B)) { // Toggle the clamp
-      if (clampstate == 0) { // If the clamp is open
+    if (input::action("clamp")) { // Toggle the clamp
+      if (clamp_state.latest() == 0) { // If the clamp is open
         set_clamp(2); // Close the clamp
       } else {
         set_clamp(0); // Open the clamp//
       }
     }
 
-    if (master.get_digital_new_press(DIGITAL_DOWN)) { // Toggle Lady Brown
-      if (ladystate == -1) {
-        ladystate = 0;
-      } else if (ladystate == 0) {
-        ladystate = 1;
-      } else if (ladystate == 1) {
-        ladystate = 2;
-      }
-    }
-
-    if (master.get_digital_new_press(DIGITAL_A)) {
+    if (input::action("rush")) {
       rush.toggle();
     }   
     // Old Clamp Arming Code
@@ -240,10 +291,12 @@ void opcontrol() {
       set_clamp(1);
     }
 
-    if (btn.get_new_press() && clampstate == 1) { // Automatically close the clamp
+    if (btn.get_new_press() && clamp_state.latest() == 1) { // Automatically close the clamp
       set_clamp(2);
     } */
 
+    motors::flush(INVEYOR_MOTOR);  // Only what changed goes out.  The drive and lady brown are flushed by whoever commands them
+    monitor::end(job);
     pros::delay(ez::util::DELAY_TIME);  // This is used for timer calculations!  Keep this ez::util::DELAY_TIME
     }
   } 
@@ -0,0 +1,305 @@
+#include "monitor.hpp"
+
+#include "liblvgl/lvgl.h"
+#include "main.h"
+
+// FreeRTOS keeps a stack high water mark when the kernel is built with it.  Weak, so a kernel
+// without it still links and stacks are reported as unknown.
+extern "C" __attribute__((weak)) uint32_t uxTaskGetStackHighWaterMark(void* task);
+
+namespace monitor {
+namespace {
+const int REPORT_PERIOD = 1000;  // ms
+const int PAGE_PERIOD = 100;     // ms between checks for a new report or show()/hide()
+
+struct job {
+  job_stats stats;
+  pros::task_t task;
+  uint64_t begin_us = 0;
+  uint64_t last_begin_us = 0;
+  uint64_t busy_us = 0;  // total time inside begin() and end()
+  uint64_t busy_reported = 0;
+  int watchdog_misses = 0;
+  int streak = 0;     // runs in a row that were late or overran
+  bool late = false;  // this run started late
+  std::function<void(const job_stats&)> watchdog;
+};
+
+pros::Mutex mutex;
+pros::Task* task = nullptr;
+std::vector<job> jobs;
+uint32_t last_report = 0;
+
+// The SD card has its own mutex so begin() and end() never wait on a file write
+pros::Mutex file_mutex;
+FILE* log_file = nullptr;
+
+// Handed to the page under mutex
+bool show_wanted = false;
+bool page_dirty = false;
+std::vector<job_stats> page;
+
+// Only touched from page_update(), which LVGL runs in its own task
+lv_obj_t* screen = nullptr;
+lv_obj_t* last_screen = nullptr;
+lv_obj_t* label = nullptr;
+bool is_shown = false;
+
+int bin(uint32_t us) {
+  int i = 0;
+  while (i < HISTOGRAM_BINS - 1 && us >= HISTOGRAM_EDGES[i]) i++;
+  return i;
+}
+
+int stack_free(pros::task_t t) {
+  if (uxTaskGetStackHighWaterMark == nullptr || t == nullptr) return -1;
+  return uxTaskGetStackHighWaterMark(t);
+}
+
+void screen_update(const std::vector<job_stats>& stats) {
+  std::string text = "task          cpu%   avg us  max us  late  over  stack\n";
+  char line[96];
+  for (auto& s : stats) {
+    if (s.instrumented) {
+      snprintf(line, sizeof(line), "%-12.12s %5.1f  %7lu %7lu %5lu %5lu %6i\n", s.name.c_str(), s.cpu_pct, (unsigned long)s.avg_us,
+               (unsigned long)s.max_us, (unsigned long)s.late, (unsigned long)s.overruns, s.stack_free);
+    } else {
+      snprintf(line, sizeof(line), "%-12.12s     -        -       -     -     - %6i\n", s.name.c_str(), s.stack_free);
+    }
+    text += line;
+  }
+  lv_label_set_text(label, text.c_str());
+}
+
+void report() {
+  mutex.take();
+  uint32_t now = pros::millis();
+  double window_us = std::max<uint32_t>(now - last_report, 1) * 1000.0;
+  last_report = now;
+  for (auto& j : jobs) {
+    j.stats.cpu_pct = 100.0 * (j.busy_us - j.busy_reported) / window_us;
+    j.busy_reported = j.busy_us;
+    j.stats.stack_free = stack_free(j.task);
+    j.stats.state = j.task ? pros::c::task_get_state(j.task) : pros::E_TASK_STATE_INVALID;
+  }
+  std::vector<job_stats> copy;
+  for (auto& j : jobs) copy.push_back(j.stats);
+  if (show_wanted) {
+    page = copy;
+    page_dirty = true;
+  }
+  mutex.give();
+
+  // Writing the card takes milliseconds, so it's done from the copy
+  file_mutex.take();
+  if (log_file) {
+    for (auto& s : copy) {
+      fprintf(log_file, "%lu,%s,%lu,%lu,%lu,%lu,%lu,%.2f,%i\n", (unsigned long)now, s.name.c_str(), (unsigned long)s.runs, (unsigned long)s.late,
+              (unsigned long)s.overruns, (unsigned long)s.avg_us, (unsigned long)s.max_us, s.cpu_pct, s.stack_free);
+    }
+    fflush(log_file);
+  }
+  file_mutex.give();
+}
+
+// PROS exports no LVGL lock, so the page is an LVGL timer (dashboard::lvgl_run()) and show(), hide()
+// and report() only leave it data
+void page_update() {
+  mutex.take();
+  bool want = show_wanted;
+  bool dirty = page_dirty;
+  std::vector<job_stats> stats;
+  if (dirty) stats.swap(page);
+  page_dirty = false;
+  mutex.give();
+
+  if (want && !screen) {
+    screen = lv_obj_create(NULL);
+    lv_obj_set_style_bg_color(screen, lv_color_hex(0x101010), LV_PART_MAIN);
+    lv_obj_set_style_text_color(screen, lv_color_hex(0xFFFFFF), LV_PART_MAIN);
+    lv_obj_set_style_text_font(screen, &lv_font_unscii_8, LV_PART_MAIN);  // Monospace, so the columns line up
+    label = lv_label_create(screen);
+    lv_obj_set_pos(label, 4, 4);
+  }
+  if (want != is_shown) {
+    if (want) {
+      last_screen = lv_scr_act();
+      lv_scr_load(screen);
+    } else if (last_screen) {
+      lv_scr_load(last_screen);
+    }
+    is_shown = want;
+  }
+  if (dirty && is_shown) screen_update(stats);
+}
+
+void task_loop() {
+  uint32_t now = pros::millis();
+  while (true) {
+    pros::Task::delay_until(&now, REPORT_PERIOD);
+    report();
+  }
+}
+}  // namespace
+
+int add(const std::string& name, uint32_t period_ms, uint32_t deadline_us) {
+  mutex.take();
+  for (size_t i = 0; i < jobs.size(); i++) {
+    if (jobs[i].stats.name != name) continue;
+    jobs[i].task = pros::c::task_get_current();
+    jobs[i].last_begin_us = 0;  // Not late just because it wasn't running
+    mutex.give();
+    return i;
+  }
+  mutex.give();
+
+  job j;
+  j.stats = {};
+  j.stats.name = name;
+  j.stats.instrumented = true;
+  j.stats.period_ms = period_ms;
+  j.stats.deadline_us = deadline_us == 0 ? period_ms * 1000 : deadline_us;
+  j.stats.stack_free = -1;
+  j.task = pros::c::task_get_current();
+  mutex.take();
+  jobs.push_back(j);
+  int id = jobs.size() - 1;
+  mutex.give();
+  return id;
+}
+
+void watch(const char* task_name) {
+  pros::task_t t = pros::c::task_get_by_name(task_name);
+  if (t == nullptr) printf("Monitor: no task named %s\n", task_name);
+  watch(task_name, t);
+}
+
+void watch(const std::string& name, pros::task_t task) {
+  job j;
+  j.stats = {};
+  j.stats.name = name;
+  j.stats.instrumented = false;
+  j.task = task;
+  j.stats.stack_free = stack_free(j.task);
+  mutex.take();
+  jobs.push_back(j);
+  mutex.give();
+}
+
+void begin(int id) {
+  uint64_t now = pros::micros();
+  mutex.take();
+  job& j = jobs[id];
+  j.begin_us = now;
+  j.late = j.last_begin_us != 0 && now - j.last_begin_us > j.stats.period_ms * 1500;
+  if (j.late) j.stats.late++;
+  j.last_begin_us = now;
+  mutex.give();
+}
+
+void end(int id) {
+  uint64_t now = pros::micros();
+  mutex.take();
+  job& j = jobs[id];
+  uint32_t took = now - j.begin_us;
+  job_stats& s = j.stats;
+  s.runs++;
+  s.last_us = took;
+  s.avg_us = s.runs == 1 ? took : s.avg_us + ((int32_t)took - (int32_t)s.avg_us) / 16;
+  s.max_us = std::max(s.max_us, took);
+  s.histogram[bin(took)]++;
+  j.busy_us += took;
+  if (took > s.deadline_us) s.overruns++;
+  j.streak = j.late || took > s.deadline_us ? j.streak + 1 : 0;
+
+  // The action runs outside the mutex so it can use the monitor too
+  std::function<void(const job_stats&)> action;
+  job_stats copy;
+  if (j.watchdog && j.watchdog_misses > 0 && j.streak == j.watchdog_misses) {
+    action = j.watchdog;
+    copy = s;
+    printf("Monitor: %s missed %i runs in a row\n", s.name.c_str(), j.streak);
+  }
+  mutex.give();
+  if (action) action(copy);
+}
+
+void watchdog_set(int id, int misses, std::function<void(const job_stats&)> action) {
+  mutex.take();
+  jobs[id].watchdog_misses = misses;
+  jobs[id].watchdog = action;
+  jobs[id].streak = 0;
+  mutex.give();
+}
+
+void initialize() {
+  if (task != nullptr) return;
+  last_report = pros::millis();
+  // UI priority, measuring shouldn't change what's measured
+  task = new pros::Task(task_loop, jobs::priority(REPORT_PERIOD, jobs::UI), TASK_STACK_DEPTH_DEFAULT, "Monitor");
+  dashboard::lvgl_run(PAGE_PERIOD, page_update);
+}
+
+std::vector<job_stats> stats_get() {
+  mutex.take();
+  std::vector<job_stats> out;
+  for (auto& j : jobs) out.push_back(j.stats);
+  mutex.give();
+  return out;
+}
+
+void print() {
+  for (auto& s : stats_get()) {
+    if (!s.instrumented) {
+      printf("%-14s state %i, %i words of stack free\n", s.name.c_str(), s.state, s.stack_free);
+      continue;
+    }
+    printf("%-14s %5.1f%% cpu, %lu runs, avg %luus, max %luus, %lu late, %lu over %luus, %i words of stack free\n  us:", s.name.c_str(), s.cpu_pct,
+           (unsigned long)s.runs, (unsigned long)s.avg_us, (unsigned long)s.max_us, (unsigned long)s.late, (unsigned long)s.overruns,
+           (unsigned long)s.deadline_us, s.stack_free);
+    for (int i = 0; i < HISTOGRAM_BINS; i++) {
+      if (i < HISTOGRAM_BINS - 1)
+        printf(" <%lu:%lu", (unsigned long)HISTOGRAM_EDGES[i], (unsigned long)s.histogram[i]);
+      else
+        printf(" more:%lu\n", (unsigned long)s.histogram[i]);
+    }
+  }
+}
+
+void log_start(const std::string& path) {
+  file_mutex.take();
+  if (log_file) fclose(log_file);
+  log_file = fopen(path.c_str(), "a");
+  if (log_file) {
+    fprintf(log_file, "time_ms,task,runs,late,overruns,avg_us,max_us,cpu_pct,stack_free\n");
+  } else {
+    printf("Monitor: couldn't open %s\n", path.c_str());
+  }
+  file_mutex.give();
+}
+
+void log_stop() {
+  file_mutex.take();
+  if (log_file) fclose(log_file);
+  log_file = nullptr;
+  file_mutex.give();
+}
+
+void show() {
+  mutex.take();
+  if (!show_wanted) {
+    show_wanted = true;
+    page.clear();
+    for (auto& j : jobs) page.push_back(j.stats);  // Something to show before the next report
+    page_dirty = true;
+  }
+  mutex.give();
+}
+
+void hide() {
+  mutex.take();
+  show_wanted = false;
+  mutex.give();
+}
+
+}  // namespace monitor
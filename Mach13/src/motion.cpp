@@ -0,0 +1,666 @@
+#include "motion.hpp"
+
+#include "main.h"
+
+namespace motion {
+namespace {
+const int DELAY = ez::util::DELAY_TIME;
+const double DT = DELAY / 1000.0;
+
+pros::Mutex mutex;
+pros::Task* task = nullptr;
+velocity_constants constants;
+e_motion_mode mode = IDLE;
+uint32_t started = 0, timeout = 0;
+double remaining = 0.0;
+
+// Wheel speeds measured from the drive encoders
+double last_left = 0.0, last_right = 0.0;
+double left_velocity = 0.0, right_velocity = 0.0;
+double last_left_target = 0.0, last_right_target = 0.0;
+
+// Adaptive pursuit
+std::vector<path::sample> pursuit_path;
+pursuit_constraints pursuit;
+bool reversed = false;
+size_t closest_index = 0;
+double lookahead_progress = 0.0;
+double commanded = 0.0;
+
+// Trajectory
+std::vector<squiggles::ProfilePoint> trajectory;
+std::vector<double> trajectory_distance;
+ramsete_constants ramsete;
+size_t trajectory_index = 0;
+
+// Chain, every step becomes one or more segments that each move the wheels in a fixed ratio
+struct segment {
+  int step;  // index of the step it came from
+  e_step type;
+  double left;  // wheel speed ratio, the faster wheel is +-1
+  double right;
+  double length;     // in traveled by the faster wheel
+  double heading;    // heading held on drives, odom degrees
+  double turn_sign;  // 1 for clockwise turns and swings
+  double max_speed;
+  bool stop;
+  double v_in = 0.0;  // planned speed entering and leaving, in/s of the faster wheel
+  double v_out = 0.0;
+};
+std::vector<segment> segments;
+chain_constants chain;
+size_t segment_index = 0;
+double segment_left = 0.0, segment_right = 0.0, segment_imu = 0.0;
+double chain_imu = 0.0, chain_theta = 0.0;
+
+// Profiled turn
+turn_constants turning;
+double turn_start = 0.0, turn_delta = 0.0;
+double turn_peak = 0.0, turn_accel_time = 0.0, turn_cruise_time = 0.0, turn_decel_time = 0.0;
+
+void velocity_measure() {
+  double left = chassis.drive_sensor_left();  // Already inches
+  double right = chassis.drive_sensor_right();
+  // Light filtering, encoder steps are coarse over 10ms
+  left_velocity += 0.5 * ((left - last_left) / DT - left_velocity);
+  right_velocity += 0.5 * ((right - last_right) / DT - right_velocity);
+  last_left = left;
+  last_right = right;
+}
+
+// Turns planned wheel speeds (in/s) into motor output, scaling both sides down together when saturated
+void wheels_set(double left_target, double right_target) {
+  double left_accel = (left_target - last_left_target) / DT;
+  double right_accel = (right_target - last_right_target) / DT;
+  last_left_target = left_target;
+  last_right_target = right_target;
+
+  double left = constants.kV * left_target + constants.kA * left_accel + constants.kP * (left_target - left_velocity);
+  double right = constants.kV * right_target + constants.kA * right_accel + constants.kP * (right_target - right_velocity);
+  double biggest = std::max(fabs(left), fabs(right));
+  if (biggest > 127.0) {
+    left *= 127.0 / biggest;
+    right *= 127.0 / biggest;
+  }
+  chassis.drive_set(left, right);
+}
+
+void finish(const char* why) {
+  mode = IDLE;
+  remaining = 0.0;
+  last_left_target = last_right_target = 0.0;
+  chassis.drive_set(0, 0);
+  if (why != nullptr) LOGI("  Motion exited: %s, %ims", why, (int)(pros::millis() - started));
+}
+
+void start(e_motion_mode new_mode, double planned_seconds) {
+  chassis.drive_mode_set(ez::DISABLE);  // EZ-Template's motions stop writing to the drive
+  last_left = chassis.drive_sensor_left();
+  last_right = chassis.drive_sensor_right();
+  started = pros::millis();
+  timeout = started + (uint32_t)(planned_seconds * 1500.0) + 1000;
+  mode = new_mode;
+}
+
+// Seconds a profile takes if it's followed exactly
+double profile_time(const std::vector<path::sample>& samples) {
+  double time = 0.0;
+  for (size_t i = 1; i < samples.size(); i++) {
+    double v = (samples[i].velocity + samples[i - 1].velocity) / 2.0;
+    time += (samples[i].distance - samples[i - 1].distance) / std::max(v, 1.0);
+  }
+  return time;
+}
+
+void pursuit_iterate() {
+  ez::pose pose = tracking::pose_get();
+  path::point robot = {pose.x, pose.y};
+  double heading = reversed ? pose.theta + 180.0 : pose.theta;
+
+  closest_index = path::closest(pursuit_path, robot, closest_index);
+  const path::sample& here = pursuit_path[closest_index];
+  const path::sample& end = pursuit_path.back();
+  double to_end = path::distance(robot, {end.x, end.y});
+  remaining = std::max(end.distance - here.distance, to_end);
+
+  if (closest_index + 1 >= pursuit_path.size() && to_end < pursuit.exit_error) {
+    finish("Pursuit done");
+    return;
+  }
+
+  // The profile already slows for curves and the end, acceleration is limited here so a late start doesn't jump
+  double target = pursuit_path[std::min(closest_index + 1, pursuit_path.size() - 1)].velocity;  // One point ahead, the start is planned at rest
+  if (closest_index + 2 >= pursuit_path.size()) target = std::min(pursuit.limits.max_velocity, sqrt(2.0 * pursuit.limits.max_decel * to_end));  // Keep decelerating onto the last point
+  commanded = target > commanded ? std::min(target, commanded + pursuit.limits.max_accel * DT) : target;
+
+  double lookahead = pursuit.lookahead_min + pursuit.lookahead_speed_gain * commanded;
+  lookahead = std::clamp(lookahead, pursuit.lookahead_min, pursuit.lookahead_max);
+  lookahead /= 1.0 + pursuit.lookahead_curvature_gain * fabs(here.curvature) * pursuit.lookahead_max;
+  lookahead = std::max(lookahead, pursuit.lookahead_min);
+
+  path::point goal;
+  path::lookahead(pursuit_path, robot, lookahead, lookahead_progress, goal);
+  double k = path::arc_curvature(robot, heading, goal);
+
+  // Curvature to the goal can still be sharper than the path, don't let it beat the lateral limit
+  if (fabs(k) > 1e-6) commanded = std::min(commanded, sqrt(pursuit.limits.max_lateral_accel / fabs(k)));
+
+  double half_width = chassis.drive_width_get() / 2.0;
+  double left = commanded * (1.0 + k * half_width);
+  double right = commanded * (1.0 - k * half_width);
+  if (reversed)
+    wheels_set(-right, -left);  // Facing backwards swaps which side is on the outside of the curve
+  else
+    wheels_set(left, right);
+}
+
+// Squiggles' yaw is 0 along +x and counterclockwise, odom's theta is 0 along +y and clockwise
+double yaw_of(double theta) { return ez::util::to_rad(90.0 - theta); }
+
+double sinc(double x) { return fabs(x) < 1e-6 ? 1.0 - x * x / 6.0 : sin(x) / x; }
+
+void trajectory_iterate() {
+  double t = (pros::millis() - started) / 1000.0;
+  while (trajectory_index + 1 < trajectory.size() && trajectory[trajectory_index + 1].time <= t) trajectory_index++;
+
+  // Reference pose and speeds, interpolated between profile points
+  const squiggles::ProfilePoint& a = trajectory[trajectory_index];
+  const squiggles::ProfilePoint& b = trajectory[std::min(trajectory_index + 1, trajectory.size() - 1)];
+  double span = b.time - a.time;
+  double f = span > 1e-6 ? std::clamp((t - a.time) / span, 0.0, 1.0) : 0.0;
+  double x_d = a.vector.pose.x + f * (b.vector.pose.x - a.vector.pose.x);
+  double y_d = a.vector.pose.y + f * (b.vector.pose.y - a.vector.pose.y);
+  double yaw_d = a.vector.pose.yaw + f * remainder(b.vector.pose.yaw - a.vector.pose.yaw, 2.0 * M_PI);
+  double v_d = a.vector.vel + f * (b.vector.vel - a.vector.vel);
+  double w_d = span > 1e-6 ? remainder(b.vector.pose.yaw - a.vector.pose.yaw, 2.0 * M_PI) / span : 0.0;
+
+  ez::pose pose = tracking::pose_get();
+  double yaw = yaw_of(reversed ? pose.theta + 180.0 : pose.theta);
+  const squiggles::ProfilePoint& end = trajectory.back();
+  double to_end = path::distance({pose.x, pose.y}, {end.vector.pose.x, end.vector.pose.y});
+  double along = trajectory_distance[trajectory_index] + f * (trajectory_distance[std::min(trajectory_index + 1, trajectory.size() - 1)] - trajectory_distance[trajectory_index]);
+  remaining = std::max(trajectory_distance.back() - along, t >= end.time ? to_end : 0.0);
+
+  if (t >= end.time) {
+    if (to_end < ramsete.exit_error) {
+      finish("Trajectory done");
+      return;
+    }
+    if ((t - end.time) * 1000.0 > ramsete.settle_time) {
+      finish("Trajectory settle time");
+      return;
+    }
+  }
+
+  // Error in the robot's frame
+  double dx = x_d - pose.x, dy = y_d - pose.y;
+  double e_x = cos(yaw) * dx + sin(yaw) * dy;
+  double e_y = -sin(yaw) * dx + cos(yaw) * dy;
+  double e_yaw = remainder(yaw_d - yaw, 2.0 * M_PI);
+
+  double k = 2.0 * ramsete.zeta * sqrt(w_d * w_d + ramsete.b * v_d * v_d);
+  double v = v_d * cos(e_yaw) + k * e_x;
+  double w = w_d + k * e_yaw + ramsete.b * v_d * sinc(e_yaw) * e_y;
+
+  double half_width = chassis.drive_width_get() / 2.0;
+  double left = v - w * half_width;
+  double right = v + w * half_width;
+  if (reversed)
+    wheels_set(-right, -left);
+  else
+    wheels_set(left, right);
+}
+
+// Turns steps into segments, tracking where the robot will be so point steps know where to face
+std::vector<segment> chain_plan(const std::vector<step>& steps, ez::pose pose, double start_speed) {
+  std::vector<segment> out;
+  double width = chassis.drive_width_get();
+  for (size_t i = 0; i < steps.size(); i++) {
+    const step& s = steps[i];
+    auto turn = [&](double delta, bool stop) {
+      double sign = delta >= 0.0 ? 1.0 : -1.0;
+      out.push_back({(int)i, STEP_TURN, sign, -sign, fabs(ez::util::to_rad(delta)) * width / 2.0, pose.theta + delta, sign, s.max_speed, stop});
+      pose.theta += delta;
+    };
+    auto drive = [&](double distance, bool stop) {
+      double sign = distance >= 0.0 ? 1.0 : -1.0;
+      out.push_back({(int)i, STEP_DRIVE, sign, sign, fabs(distance), pose.theta, 0.0, s.max_speed, stop});
+      pose.x += distance * sin(ez::util::to_rad(pose.theta));
+      pose.y += distance * cos(ez::util::to_rad(pose.theta));
+    };
+
+    switch (s.type) {
+      case STEP_DRIVE:
+        drive(s.target, s.stop);
+        break;
+      case STEP_TURN:
+        turn(remainder(s.target - pose.theta, 360.0), s.stop);
+        break;
+      case STEP_SWING: {
+        double delta = remainder(s.target - pose.theta, 360.0);
+        double sign = delta >= 0.0 ? 1.0 : -1.0;
+        bool left_side = s.side == ez::LEFT_SWING;
+        out.push_back({(int)i, STEP_SWING, left_side ? sign : 0.0, left_side ? 0.0 : -sign, fabs(ez::util::to_rad(delta)) * width, pose.theta + delta, sign, s.max_speed, s.stop});
+        // Rotate about the side that stays still
+        double rad = ez::util::to_rad(pose.theta), turn_rad = ez::util::to_rad(delta);
+        double side = left_side ? width / 2.0 : -width / 2.0;
+        double pivot_x = pose.x + side * cos(rad), pivot_y = pose.y - side * sin(rad);
+        double dx = pose.x - pivot_x, dy = pose.y - pivot_y;
+        pose.x = pivot_x + dx * cos(turn_rad) + dy * sin(turn_rad);
+        pose.y = pivot_y - dx * sin(turn_rad) + dy * cos(turn_rad);
+        pose.theta += delta;
+        break;
+      }
+      case STEP_POINT: {
+        double face = ez::util::to_deg(atan2(s.point.x - pose.x, s.point.y - pose.y));
+        if (s.direction == ez::rev) face += 180.0;
+        double delta = remainder(face - pose.theta, 360.0);
+        if (fabs(delta) > 2.0) turn(delta, false);
+        double distance = ez::util::distance_to_point(s.point, pose);
+        drive(s.direction == ez::rev ? -distance : distance, s.stop);
+        break;
+      }
+    }
+  }
+  if (out.empty()) return out;
+  out.back().stop = true;
+
+  // Boundary speeds, limited by how much either wheel's speed has to change there
+  for (size_t i = 0; i + 1 < out.size(); i++) {
+    double jump = std::max(fabs(out[i].left - out[i + 1].left), fabs(out[i].right - out[i + 1].right));
+    double v = std::min(out[i].max_speed, out[i + 1].max_speed);
+    if (jump > 1e-6) v = std::min(v, chain.junction_speed / jump);
+    out[i].v_out = out[i].stop ? 0.0 : v;
+  }
+  out.back().v_out = 0.0;
+
+  // Forward pass for acceleration, backward pass for deceleration
+  out.front().v_in = std::min(start_speed, out.front().max_speed);
+  for (size_t i = 0; i < out.size(); i++) {
+    if (i > 0) out[i].v_in = out[i - 1].v_out;
+    out[i].v_out = std::min(out[i].v_out, sqrt(out[i].v_in * out[i].v_in + 2.0 * chain.max_accel * out[i].length));
+  }
+  for (size_t i = out.size(); i-- > 0;) {
+    out[i].v_in = std::min(out[i].v_in, sqrt(out[i].v_out * out[i].v_out + 2.0 * chain.max_decel * out[i].length));
+    if (i > 0) out[i - 1].v_out = out[i].v_in;
+  }
+  return out;
+}
+
+// Planned speed partway through a segment
+double chain_speed(const segment& seg, double progress) {
+  double v = seg.max_speed;
+  v = std::min(v, sqrt(seg.v_in * seg.v_in + 2.0 * chain.max_accel * (std::max(progress, 0.0) + 0.5)));  // A little ahead so it can start from rest
+  v = std::min(v, sqrt(seg.v_out * seg.v_out + 2.0 * chain.max_decel * std::max(seg.length - progress, 0.0)));
+  return v;
+}
+
+double chain_time(const std::vector<segment>& plan) {
+  double time = 0.0;
+  for (auto& seg : plan) {
+    for (double s = 0.0; s < seg.length; s += 0.5) time += std::min(0.5, seg.length - s) / std::max(chain_speed(seg, s), 1.0);
+  }
+  return time;
+}
+
+void segment_start() {
+  segment_left = chassis.drive_sensor_left();  // Already inches
+  segment_right = chassis.drive_sensor_right();
+  segment_imu = heading::get();
+}
+
+void chain_iterate() {
+  const segment& seg = segments[segment_index];
+  double width = chassis.drive_width_get();
+  double imu = heading::get();
+
+  double progress = 0.0;
+  if (seg.type == STEP_DRIVE) {
+    double left = chassis.drive_sensor_left() - segment_left;
+    double right = chassis.drive_sensor_right() - segment_right;
+    progress = (left + right) / 2.0 * seg.left;
+  } else {
+    // Turns and swings measure progress with the IMU, wheels slip when turning
+    progress = ez::util::to_rad(imu - segment_imu) * seg.turn_sign * (seg.type == STEP_TURN ? width / 2.0 : width);
+  }
+
+  double to_go = seg.length - progress;
+  remaining = std::max(to_go, 0.0);
+  for (size_t i = segment_index + 1; i < segments.size(); i++) remaining += segments[i].length;
+
+  bool done = seg.stop ? fabs(to_go) < chain.exit_error : to_go <= 0.0;
+  if (done) {
+    if (segment_index + 1 >= segments.size()) {
+      finish("Chain done");
+      return;
+    }
+    segment_index++;
+    segment_start();
+    chain_iterate();
+    return;
+  }
+
+  double v = chain_speed(seg, progress);
+  if (seg.stop) v = std::min(v, chain.settle_kP * to_go);  // Goes negative past the end to pull back
+
+  double correction = 0.0;
+  if (seg.type == STEP_DRIVE) {
+    double heading = chain_theta + (imu - chain_imu);
+    correction = chain.heading_kP * (seg.heading - heading);
+  }
+  wheels_set(seg.left * v + correction, seg.right * v - correction);
+}
+
+// Where a trapezoidal turn profile is at time t, in degrees from the start and deg/s
+void turn_reference(double t, double& angle, double& rate, double& accel) {
+  double a = turning.max_accel, d = turning.max_decel;
+  if (t < turn_accel_time) {
+    rate = a * t;
+    angle = 0.5 * a * t * t;
+    accel = a;
+    return;
+  }
+  double angle_accel = 0.5 * turn_peak * turn_accel_time;
+  t -= turn_accel_time;
+  if (t < turn_cruise_time) {
+    rate = turn_peak;
+    angle = angle_accel + turn_peak * t;
+    accel = 0.0;
+    return;
+  }
+  double angle_cruise = angle_accel + turn_peak * turn_cruise_time;
+  t = std::min(t - turn_cruise_time, turn_decel_time);
+  rate = turn_peak - d * t;
+  angle = angle_cruise + turn_peak * t - 0.5 * d * t * t;
+  accel = t < turn_decel_time ? -d : 0.0;
+}
+
+void turn_plan(double delta) {
+  double distance = fabs(delta);
+  double a = turning.max_accel, d = turning.max_decel;
+  // Triangle if the turn is too short to reach max_rate
+  turn_peak = std::min(turning.max_rate, sqrt(2.0 * distance * a * d / (a + d)));
+  turn_accel_time = turn_peak / a;
+  turn_decel_time = turn_peak / d;
+  double ramps = 0.5 * turn_peak * (turn_accel_time + turn_decel_time);
+  turn_cruise_time = turn_peak > 0.0 ? std::max(0.0, (distance - ramps) / turn_peak) : 0.0;
+  turn_start = heading::get();
+  turn_delta = delta;
+}
+
+void profiled_turn_iterate() {
+  double t = (pros::millis() - started) / 1000.0;
+  double imu = heading::get();
+
+  double gyro = heading::rate_get();  // Same frame and sign as the heading, from whichever IMUs are healthy
+
+  double angle, rate, accel;
+  turn_reference(t, angle, rate, accel);
+  double sign = turn_delta >= 0.0 ? 1.0 : -1.0;
+  double target = turn_start + sign * angle;
+  double error = target - imu;
+  double end_error = turn_start + turn_delta - imu;
+  remaining = fabs(end_error);
+
+  double profile_time = turn_accel_time + turn_cruise_time + turn_decel_time;
+  if (t >= profile_time) {
+    if (fabs(end_error) < turning.exit_error && fabs(gyro) < turning.exit_rate) {
+      finish("Turn done");
+      return;
+    }
+    if ((t - profile_time) * 1000.0 > turning.settle_time) {
+      finish("Turn settle time");
+      return;
+    }
+  }
+
+  double output = turning.kV * sign * rate + turning.kA * sign * accel + turning.kP * error + turning.kD * (sign * rate - gyro);
+  output = std::clamp(output, -127.0, 127.0);
+  chassis.drive_set(output, -output);
+}
+
+void task_loop() {
+  uint32_t now = pros::millis();
+  int job = monitor::add("Motion", DELAY);
+  while (true) {
+    monitor::begin(job);
+    mutex.take();
+    velocity_measure();
+    if (mode != IDLE && pros::millis() > timeout) finish("Timed out");
+
+    switch (mode) {
+      case ADAPTIVE_PURSUIT:
+        pursuit_iterate();
+        break;
+      case TRAJECTORY:
+        trajectory_iterate();
+        break;
+      case CHAIN:
+        chain_iterate();
+        break;
+      case PROFILED_TURN:
+        profiled_turn_iterate();
+        break;
+      default:
+        break;
+    }
+    mutex.give();
+    monitor::end(job);
+    pros::Task::delay_until(&now, DELAY);
+  }
+}
+
+void task_start() {
+  if (task == nullptr) task = new pros::Task(task_loop, jobs::priority(DELAY, jobs::CONTROL), TASK_STACK_DEPTH_DEFAULT, "Motion");
+}
+}  // namespace
+
+void velocity_constants_set(double kV, double kA, double kP) {
+  mutex.take();
+  constants = {kV, kA, kP};
+  mutex.give();
+}
+
+velocity_constants velocity_constants_get() { return constants; }
+
+void pursuit_set(std::vector<ez::pose> points, ez::drive_directions direction, pursuit_constraints new_constraints) {
+  task_start();
+  ez::pose pose = chassis.odom_pose_get();  // Straight from EZ-Template, an odom_xyt_set() just before this might not be published yet
+  std::vector<path::point> waypoints = {{pose.x, pose.y}};
+  for (auto& p : points) waypoints.push_back({p.x, p.y});
+
+  // Start from however fast the robot is already going, so pursuits chain without a dip
+  double current = std::max(0.0, (direction == ez::rev ? -1.0 : 1.0) * (left_velocity + right_velocity) / 2.0);
+  new_constraints.limits.start_velocity = std::max(new_constraints.limits.start_velocity, current);
+
+  std::vector<path::sample> samples = path::profile(path::smooth(path::inject(waypoints, new_constraints.spacing)), new_constraints.limits);
+
+  mutex.take();
+  pursuit_path = samples;
+  pursuit = new_constraints;
+  reversed = direction == ez::rev;
+  closest_index = 0;
+  lookahead_progress = 0.0;
+  commanded = new_constraints.limits.start_velocity;
+  start(ADAPTIVE_PURSUIT, profile_time(samples));
+  mutex.give();
+}
+
+void pursuit_set(std::vector<ez::united_pose> points, ez::drive_directions direction, pursuit_constraints new_constraints) {
+  std::vector<ez::pose> converted;
+  for (auto& p : points) converted.push_back(ez::util::united_pose_to_pose(p));
+  pursuit_set(converted, direction, new_constraints);
+}
+
+void trajectory_set(std::vector<squiggles::ProfilePoint> profile, ez::drive_directions direction, ramsete_constants constants) {
+  if (profile.empty()) return;
+  task_start();
+  std::vector<double> distance = {0.0};
+  for (size_t i = 1; i < profile.size(); i++) {
+    distance.push_back(distance.back() + path::distance({profile[i - 1].vector.pose.x, profile[i - 1].vector.pose.y}, {profile[i].vector.pose.x, profile[i].vector.pose.y}));
+  }
+
+  mutex.take();
+  trajectory = profile;
+  trajectory_distance = distance;
+  ramsete = constants;
+  reversed = direction == ez::rev;
+  trajectory_index = 0;
+  start(TRAJECTORY, profile.back().time);
+  mutex.give();
+}
+
+step drive_step(double distance, double max_speed, bool stop) {
+  return {STEP_DRIVE, distance, {0, 0, 0}, ez::LEFT_SWING, ez::fwd, max_speed, stop};
+}
+
+step turn_step(double theta, double max_speed, bool stop) {
+  return {STEP_TURN, theta, {0, 0, 0}, ez::LEFT_SWING, ez::fwd, max_speed, stop};
+}
+
+step swing_step(ez::e_swing side, double theta, double max_speed, bool stop) {
+  return {STEP_SWING, theta, {0, 0, 0}, side, ez::fwd, max_speed, stop};
+}
+
+step point_step(ez::pose target, ez::drive_directions direction, double max_speed, bool stop) {
+  return {STEP_POINT, 0.0, target, ez::LEFT_SWING, direction, max_speed, stop};
+}
+
+void chain_set(std::vector<step> steps, chain_constants constants) {
+  if (steps.empty()) return;
+  task_start();
+
+  mutex.take();
+  chain = constants;
+  ez::pose pose = chassis.odom_pose_get();  // Straight from EZ-Template, like pursuit_set()
+  double current = std::max(0.0, std::max(fabs(left_velocity), fabs(right_velocity)));
+  std::vector<segment> plan = chain_plan(steps, pose, current);
+  // Only carry speed in if the robot is already moving the way the first segment goes
+  if (plan.front().left * left_velocity + plan.front().right * right_velocity <= 0.0) {
+    plan = chain_plan(steps, pose, 0.0);
+  }
+  segments = plan;
+  segment_index = 0;
+  chain_imu = heading::get();
+  chain_theta = pose.theta;
+  segment_start();
+  start(CHAIN, chain_time(plan));
+  mutex.give();
+}
+
+int chain_step_get() {
+  mutex.take();
+  int index = mode == CHAIN ? segments[segment_index].step : -1;
+  mutex.give();
+  return index;
+}
+
+void wait_until_step(int index) {
+  while (mode_get() == CHAIN && chain_step_get() < index) pros::delay(DELAY);
+}
+
+void turn_constants_set(turn_constants constants) {
+  mutex.take();
+  turning = constants;
+  mutex.give();
+}
+
+turn_constants turn_constants_get() { return turning; }
+
+void turn_set(double theta, ez::e_angle_behavior behavior) {
+  task_start();
+  mutex.take();
+  double current = heading::get();
+  double delta = theta - current;
+  switch (behavior) {
+    case ez::shortest:
+      delta = remainder(delta, 360.0);
+      break;
+    case ez::longest:
+      delta = remainder(delta, 360.0);
+      if (fabs(delta) > 1e-6) delta -= std::copysign(360.0, delta);
+      break;
+    case ez::cw:
+      delta = fmod(delta, 360.0);
+      if (delta < 0.0) delta += 360.0;
+      break;
+    case ez::ccw:
+      delta = fmod(delta, 360.0);
+      if (delta > 0.0) delta -= 360.0;
+      break;
+    default:  // raw goes to exactly the number given
+      break;
+  }
+  turn_plan(delta);
+  start(PROFILED_TURN, turn_accel_time + turn_cruise_time + turn_decel_time);
+  mutex.give();
+}
+
+void turn_set(okapi::QAngle theta, ez::e_angle_behavior behavior) { turn_set(theta.convert(okapi::degree), behavior); }
+
+void turn_relative_set(double theta) { turn_set(heading::get() + theta, ez::raw); }
+
+void turn_relative_set(okapi::QAngle theta) { turn_relative_set(theta.convert(okapi::degree)); }
+
+void turn_characterize() {
+  cancel();
+  chassis.drive_mode_set(ez::DISABLE);
+  double last = heading::get();
+  double peak = 0.0, early = 0.0;
+  uint32_t begin = pros::millis(), now = begin;
+  chassis.drive_set(127, -127);
+  while (pros::millis() - begin < 800) {
+    pros::Task::delay_until(&now, DELAY);
+    double current = heading::get();
+    double rate = (current - last) / DT;
+    last = current;
+    if (pros::millis() - begin <= 100) early = rate;  // The first 100ms is close to pure acceleration
+    peak = std::max(peak, rate);
+  }
+  pros::motor_brake_mode_e_t brake = chassis.drive_brake_get();
+  chassis.drive_brake_set(pros::E_MOTOR_BRAKE_HOLD);
+  chassis.drive_set(0, 0);
+  pros::delay(300);
+  chassis.drive_brake_set(brake);
+
+  if (peak < 30.0) {
+    LOGW("Turn characterization failed, the robot barely turned (%.1f deg/s)", peak);
+    return;
+  }
+  mutex.take();
+  turning.max_rate = 0.8 * peak;
+  turning.max_accel = 0.8 * early / 0.1;
+  turning.max_decel = 0.8 * turning.max_accel;
+  turning.kV = 127.0 / peak;
+  mutex.give();
+  LOGI("Turn characterization: top rate %.0f deg/s, acceleration %.0f deg/s^2, kV %.3f", peak, early / 0.1, 127.0 / peak);
+}
+
+void wait() {
+  while (mode_get() != IDLE) pros::delay(DELAY);
+}
+
+void wait_until_remaining(double distance) {
+  while (mode_get() != IDLE) {
+    mutex.take();
+    bool close = remaining <= distance;
+    mutex.give();
+    if (close) return;
+    pros::delay(DELAY);
+  }
+}
+
+void cancel() {
+  mutex.take();
+  if (mode != IDLE) finish("Cancelled");
+  mutex.give();
+}
+
+e_motion_mode mode_get() {
+  mutex.take();
+  e_motion_mode current = mode;
+  mutex.give();
+  return current;
+}
+
+}  // namespace motion
@@ -0,0 +1,146 @@
+#include "motors.hpp"
+
+#include "main.h"
+
+namespace motors {
+namespace {
+const uint32_t REFRESH = 100;  // ms an unchanged command goes without being resent
+
+enum e_kind { NONE = 0,
+              VOLTAGE = 1,
+              VELOCITY = 2,
+              BRAKE = 3 };
+
+typedef struct command {
+  e_kind kind;
+  int32_t value;
+  int32_t value2;  // right side, for the drive
+  bool operator==(const command& other) const { return kind == other.kind && value == other.value && value2 == other.value2; }
+} command;
+
+struct output {
+  std::string name;
+  pros::AbstractMotor* motor;  // nullptr for the drive
+  command held;                // waiting for flush()
+  command sent;
+  uint32_t sent_time;
+};
+
+// Function statics so motors can be added from other files' static initializers
+std::vector<output>& outputs() {
+  static std::vector<output> list = {{"drive", nullptr, {NONE, 0, 0}, {NONE, 0, 0}, 0}};
+  return list;
+}
+
+pros::Mutex& mutex() {
+  static pros::Mutex m;
+  return m;
+}
+
+stats_t counting = {}, last_second = {};
+uint32_t second_start = 0;
+
+void hold(int id, command c) {
+  mutex().take();
+  auto& list = outputs();
+  if (id >= 0 && id < (int)list.size()) {
+    list[id].held = c;
+    counting.commands++;
+  }
+  mutex().give();
+}
+
+// Motors a write to this output reaches
+uint32_t devices(const output& o) {
+  if (o.motor == nullptr) return chassis.left_motors.size() + chassis.right_motors.size();
+  return o.motor->size();
+}
+
+void send(const output& o) {
+  const command& c = o.held;
+  if (o.motor == nullptr) {
+    chassis.drive_set(c.value, c.value2);
+    return;
+  }
+  switch (c.kind) {
+    case VOLTAGE:
+      o.motor->move(c.value);
+      break;
+    case VELOCITY:
+      o.motor->move_velocity(c.value);
+      break;
+    case BRAKE:
+      o.motor->brake();
+      break;
+    case NONE:
+      break;
+  }
+}
+}  // namespace
+
+int add(const std::string& name, pros::AbstractMotor& motor) {
+  mutex().take();
+  auto& list = outputs();
+  list.push_back({name, &motor, {NONE, 0, 0}, {NONE, 0, 0}, 0});
+  int id = list.size() - 1;
+  mutex().give();
+  return id;
+}
+
+void move(int id, int32_t voltage) { hold(id, {VOLTAGE, std::clamp(voltage, -127, 127), 0}); }
+
+void move_velocity(int id, int32_t velocity) { hold(id, {VELOCITY, velocity, 0}); }
+
+void brake(int id) { hold(id, {BRAKE, 0, 0}); }
+
+void drive_set(int left, int right) { hold(DRIVE, {VOLTAGE, left, right}); }
+
+void flush(int id) {
+  uint32_t now = pros::millis();
+  mutex().take();
+  auto& list = outputs();
+  if (id >= 0 && id < (int)list.size() && list[id].held.kind != NONE) {
+    output& o = list[id];
+    bool owned = o.motor != nullptr || chassis.drive_mode_get() == ez::DISABLE;  // drive_set() also ends EZ-Template's motions
+    if (o.held == o.sent && owned && now - o.sent_time < REFRESH) {
+      counting.suppressed++;
+    } else {
+      send(o);
+      o.sent = o.held;
+      o.sent_time = now;
+      counting.writes += devices(o);
+    }
+    o.held.kind = NONE;
+  }
+  counting.flushes++;
+  if (now - second_start >= 1000) {
+    last_second = counting;
+    counting = {};
+    second_start = now;
+  }
+  mutex().give();
+}
+
+void invalidate(int id) {
+  mutex().take();
+  auto& list = outputs();
+  for (int i = 0; i < (int)list.size(); i++) {
+    if (id == ALL || id == i) list[i].sent.kind = NONE;
+  }
+  mutex().give();
+}
+
+stats_t stats_get() {
+  mutex().take();
+  stats_t copy = last_second;
+  mutex().give();
+  return copy;
+}
+
+void print() {
+  stats_t s = stats_get();
+  printf("Motors: %lu commands, %lu device writes, %lu suppressed, %lu flushes in the last second\n", (unsigned long)s.commands,
+         (unsigned long)s.writes, (unsigned long)s.suppressed, (unsigned long)s.flushes);
+}
+
+}  // namespace motors
@@ -0,0 +1,157 @@
+#include "sensors.hpp"
+
+#include "main.h"
+
+namespace sensors {
+namespace {
+const int DELAY = ez::util::DELAY_TIME;
+const int STALE_TIME = DELAY * 2;  // ms without an update() before the task takes over
+const int POOL_SIZE = 3;           // frames, enough that one is always free while others are held
+
+struct device {
+  std::string name;
+  std::function<double()> read;
+  double smoothing;
+};
+
+// Function statics so devices can be added from other files' static initializers
+std::vector<device>& devices() {
+  static std::vector<device> list;
+  return list;
+}
+
+pros::Mutex& mutex() {
+  static pros::Mutex m;
+  return m;
+}
+
+pros::Task* task = nullptr;
+std::shared_ptr<frame> pool[POOL_SIZE];
+std::shared_ptr<frame> current;
+stats_t stats = {};
+uint32_t last_update = 0;
+
+// A frame nobody outside the hub is holding, reused so ticks don't allocate
+std::shared_ptr<frame> frame_free() {
+  for (auto& f : pool) {
+    if (f != current && f.use_count() == 1) return f;
+  }
+  return std::make_shared<frame>();  // Every pooled frame is held, this one is dropped once released
+}
+
+void read_all(bool from_task) {
+  mutex().take();
+  std::shared_ptr<frame> next = frame_free();
+  auto& list = devices();
+  uint32_t start = pros::micros();
+  next->time = pros::millis();
+  next->tick = stats.ticks;
+  next->values.resize(list.size(), 0.0);
+  for (size_t i = 0; i < list.size(); i++) {
+    double reading = list[i].read();
+    double previous = current && i < current->values.size() ? current->values[i] : reading;
+    if (!std::isfinite(reading)) reading = previous;  // Unplugged, keep the last good value
+    next->values[i] = previous + list[i].smoothing * (reading - previous);
+  }
+  next->read_us = pros::micros() - start;
+
+  current = next;
+  stats.ticks++;
+  stats.task_ticks += from_task;
+  stats.last_read_us = next->read_us;
+  stats.max_read_us = std::max(stats.max_read_us, next->read_us);
+  stats.devices = list.size();
+  if (!from_task) last_update = next->time;
+  mutex().give();
+}
+
+void task_loop() {
+  uint32_t now = pros::millis();
+  int job = monitor::add("Sensors", DELAY);
+  while (true) {
+    monitor::begin(job);
+    mutex().take();
+    bool stale = pros::millis() - last_update >= STALE_TIME;
+    mutex().give();
+    if (stale) read_all(true);
+    monitor::end(job);
+    pros::Task::delay_until(&now, DELAY);
+  }
+}
+}  // namespace
+
+int add(const std::string& name, std::function<double()> read, double smoothing) {
+  mutex().take();
+  devices().push_back({name, read, std::clamp(smoothing, 0.0, 1.0)});
+  int id = devices().size() - 1;
+  mutex().give();
+  return id;
+}
+
+int find(const std::string& name) {
+  mutex().take();
+  int id = -1;
+  for (size_t i = 0; i < devices().size(); i++) {
+    if (devices()[i].name == name) id = i;
+  }
+  mutex().give();
+  return id;
+}
+
+void smoothing_set(int id, double smoothing) {
+  mutex().take();
+  if (id >= 0 && id < (int)devices().size()) devices()[id].smoothing = std::clamp(smoothing, 0.0, 1.0);
+  mutex().give();
+}
+
+void initialize() {
+  if (task != nullptr) return;
+  for (auto& f : pool) f = std::make_shared<frame>();
+  read_all(true);
+  task = new pros::Task(task_loop, jobs::priority(DELAY, jobs::CONTROL), TASK_STACK_DEPTH_DEFAULT, "Sensors");
+}
+
+void update() {
+  if (task == nullptr) return;
+  read_all(false);
+}
+
+std::shared_ptr<const frame> get() {
+  mutex().take();
+  std::shared_ptr<const frame> copy = current;
+  mutex().give();
+  return copy;
+}
+
+double value(int id) {
+  mutex().take();
+  double reading = 0.0;
+  if (current && id >= 0 && id < (int)current->values.size()) {
+    reading = current->values[id];
+  } else if (id >= 0 && id < (int)devices().size()) {
+    reading = devices()[id].read();
+  }
+  mutex().give();
+  return reading;
+}
+
+stats_t stats_get() {
+  mutex().take();
+  stats_t copy = stats;
+  mutex().give();
+  return copy;
+}
+
+void print() {
+  std::shared_ptr<const frame> f = get();
+  stats_t s = stats_get();
+  printf("Sensors: %i devices, tick %lu, last read %luus, max %luus\n", s.devices, (unsigned long)s.ticks, (unsigned long)s.last_read_us,
+         (unsigned long)s.max_read_us);
+  mutex().take();
+  for (size_t i = 0; i < devices().size(); i++) {
+    printf("  %-20s %.3f\n", devices()[i].name.c_str(), f && i < f->values.size() ? f->values[i] : NAN);
+  }
+  mutex().give();
+}
+
+}  // namespace sensors
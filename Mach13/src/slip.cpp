@@ -0,0 +1,188 @@
+#include "slip.hpp"
+
+#include "main.h"
+
+namespace slip {
+namespace {
+const int DELAY = ez::util::DELAY_TIME;
+const double DT = DELAY / 1000.0;
+const double G = 386.09;  // in/s^2
+const double RESET_JUMP = 2.0;  // in the wheels can move in one loop, about 2.5 times top speed, more is a reset
+const size_t EVENTS_MAX = 32;
+
+pros::Mutex mutex;
+pros::Task* task = nullptr;
+pros::Task* odom_task = nullptr;
+constants_t constants;
+std::vector<event> events;
+bool slipping_now = false;
+
+void report(e_event type, double magnitude) {
+  event e = {type, pros::millis(), magnitude, tracking::pose_get()};
+  mutex.take();
+  if (events.size() >= EVENTS_MAX) events.erase(events.begin());
+  events.push_back(e);
+  mutex.give();
+  chassis.interfered = true;
+  LOGI("Slip: event %i (%.0f) at (%.1f, %.1f)", (int)type, magnitude, e.pose.x, e.pose.y);
+}
+
+void task_loop() {
+  double last_left = chassis.drive_sensor_left();  // Already inches
+  double last_right = chassis.drive_sensor_right();
+  double last_imu = heading::get();
+  double left_velocity = 0.0, right_velocity = 0.0, last_speed = 0.0;
+  double encoder_accel = 0.0, imu_accel = 0.0, gyro_rate = 0.0;
+  int spin_ms = 0, slip_ms = 0, impact_ms = 0, stall_ms = 0, grip_ms = 0;
+  bool spin_reported = false, slip_reported = false, impact_reported = false, stall_reported = false;
+
+  uint32_t now = pros::millis();
+  int job = monitor::add("Slip Detect", DELAY);
+  while (true) {
+    monitor::begin(job);
+    mutex.take();
+    constants_t c = constants;
+    mutex.give();
+
+    // What the encoders say
+    double left = chassis.drive_sensor_left();
+    double right = chassis.drive_sensor_right();
+    double imu = heading::get();
+    if (fabs(left - last_left) > RESET_JUMP || fabs(right - last_right) > RESET_JUMP || fabs(imu - last_imu) > 20.0) {
+      // Faster than the robot can move, a sensor was reset
+      last_left = left;
+      last_right = right;
+      last_imu = imu;
+      monitor::end(job);
+      pros::Task::delay_until(&now, DELAY);
+      continue;
+    }
+    left_velocity += 0.5 * ((left - last_left) / DT - left_velocity);
+    right_velocity += 0.5 * ((right - last_right) / DT - right_velocity);
+    last_left = left;
+    last_right = right;
+    double speed = (left_velocity + right_velocity) / 2.0;
+    double encoder_rate = ez::util::to_deg((left_velocity - right_velocity) / chassis.drive_width_get());  // Clockwise, like the IMU
+    encoder_accel += 0.3 * ((speed - last_speed) / DT - encoder_accel);
+    last_speed = speed;
+
+    // What the IMU says
+    gyro_rate += 0.5 * ((imu - last_imu) / DT - gyro_rate);
+    last_imu = imu;
+    imu_accel += 0.3 * (heading::accel_get() * G - imu_accel);  // From the healthy IMUs, never PROS_ERR_F
+    // The accelerometer also feels the turn, so compare against everything the encoders explain
+    double expected_accel = hypot(encoder_accel, speed * ez::util::to_rad(gyro_rate));
+
+    // A disagreement has to last confirm_time before it counts
+    auto hold = [&](bool condition, int& ms) { ms = condition ? ms + DELAY : 0; };
+    hold(fabs(encoder_rate - gyro_rate) > c.spin_rate, spin_ms);
+    hold(fabs(encoder_accel) - imu_accel > c.slip_accel, slip_ms);
+    hold(imu_accel - expected_accel > c.impact_accel, impact_ms);
+    hold(chassis.drive_mA_left() > c.stall_current && chassis.drive_mA_right() > c.stall_current && fabs(speed) < c.stall_speed, stall_ms);
+
+    bool spin = spin_ms >= c.confirm_time, wheel_slip = slip_ms >= c.confirm_time;
+    if (spin && !spin_reported) report(SPIN, encoder_rate - gyro_rate);
+    if (wheel_slip && !slip_reported) report(WHEEL_SLIP, fabs(encoder_accel) - imu_accel);
+    if (impact_ms >= c.confirm_time && !impact_reported) report(IMPACT, imu_accel - expected_accel);
+    if (stall_ms >= c.stall_time && !stall_reported) report(STALL, (chassis.drive_mA_left() + chassis.drive_mA_right()) / 2.0);
+    spin_reported = spin;
+    slip_reported = wheel_slip;
+    impact_reported = impact_ms >= c.confirm_time;
+    stall_reported = stall_ms >= c.stall_time;
+
+    // Slipping ends once the sensors have agreed for a while
+    grip_ms = (spin || wheel_slip) ? 0 : grip_ms + DELAY;
+    bool now_slipping = spin || wheel_slip || (slipping_now && grip_ms < c.release_time);
+
+    mutex.take();
+    slipping_now = now_slipping;
+    mutex.give();
+
+    monitor::end(job);
+    pros::Task::delay_until(&now, DELAY);
+  }
+}
+
+// Odometry runs inside EZ-Template, so while slipping, most of the encoder motion it just added is taken back out
+//  This writes the pose back, so it reads EZ-Template's own copy rather than the published one (tracking.hpp)
+void odom_loop() {
+  ez::pose last_pose = chassis.odom_pose_get();
+  uint32_t now = pros::millis();
+  int job = monitor::add("Slip Odom", DELAY);
+  while (true) {
+    monitor::begin(job);
+    mutex.take();
+    bool now_slipping = slipping_now;
+    double weight = constants.odom_weight;
+    mutex.give();
+
+    ez::pose pose = chassis.odom_pose_get();
+    double dx = pose.x - last_pose.x, dy = pose.y - last_pose.y;
+    if (now_slipping && hypot(dx, dy) < 6.0) {  // Bigger jumps are odom_xy_set() calls from autons
+      pose.x = last_pose.x + weight * dx;
+      pose.y = last_pose.y + weight * dy;
+      chassis.odom_xy_set(pose.x, pose.y);
+    }
+    last_pose = pose;
+
+    monitor::end(job);
+    pros::Task::delay_until(&now, DELAY);
+  }
+}
+}  // namespace
+
+void initialize() {
+  if (task != nullptr) return;
+  task = new pros::Task(task_loop, jobs::priority(DELAY, jobs::ESTIMATION), TASK_STACK_DEPTH_DEFAULT, "Slip Detect");
+  // Below EZ-Template's task so its odometry update is never half done when this writes the pose, see tracking.hpp
+  odom_task = new pros::Task(odom_loop, jobs::priority(DELAY, jobs::ODOMETRY), TASK_STACK_DEPTH_DEFAULT, "Slip Odom");
+}
+
+void constants_set(constants_t new_constants) {
+  mutex.take();
+  constants = new_constants;
+  mutex.give();
+}
+
+constants_t constants_get() {
+  mutex.take();
+  constants_t copy = constants;
+  mutex.give();
+  return copy;
+}
+
+bool slipping() {
+  mutex.take();
+  bool copy = slipping_now;
+  mutex.give();
+  return copy;
+}
+
+bool interfered() {
+  mutex.take();
+  bool any = !events.empty();
+  mutex.give();
+  return any;
+}
+
+void clear() {
+  mutex.take();
+  events.clear();
+  mutex.give();
+}
+
+event last_event_get() {
+  mutex.take();
+  event copy = events.empty() ? event{NONE, 0, 0.0, {0, 0, 0}} : events.back();
+  mutex.give();
+  return copy;
+}
+
+std::vector<event> events_get() {
+  mutex.take();
+  std::vector<event> copy = events;
+  mutex.give();
+  return copy;
+}
+
+}  // namespace slip
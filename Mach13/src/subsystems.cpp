@@ -0,0 +1,116 @@
+#include "main.h"
+
+namespace {
+const int INPUT_TIMEOUT = 50;      // ms without driver input before the Lady Brown job lets go of the arm
+const int CONTROLLER_PERIOD = 50;  // ms, the controller drops writes closer together than this
+
+// Lady Brown
+//  Same states as driving always had, now owned by one job instead of opcontrol()
+void ladybrown_run() {
+  static int state = 0;
+  static ladybrown_input last = {0, false, false};
+  static uint32_t last_input = 0;
+  static bool idle = true;
+
+  ladybrown_input in;
+  bool next = false;
+  while (ladybrown_command.receive(in)) {
+    next = next || in.next;
+    last = in;
+    last_input = pros::millis();
+  }
+  if (pros::millis() - last_input > INPUT_TIMEOUT) {
+    idle = true;
+    return;  // Autonomous moves the arm itself
+  }
+  if (idle) motors::invalidate(LDB_MOTOR);  // Whatever autonomous left the arm doing, the next command replaces it
+  idle = false;
+
+  double angle = arm::pct_get();
+  if (last.manual > 0) {
+    if (angle < MAX_ANGLE) {
+      state = -1;
+      motors::move_velocity(LDB_MOTOR, LDB_SPEED);
+    } else {
+      motors::brake(LDB_MOTOR);
+    }
+  } else if (last.manual < 0) {
+    if (angle > MIN_ANGLE) {
+      state = -1;
+      motors::move_velocity(LDB_MOTOR, -1*LDB_SPEED);
+    } else {
+      motors::brake(LDB_MOTOR);
+    }
+  } else {
+    if (state == 0 and angle > MIN_ANGLE) {
+      motors::move_velocity(LDB_MOTOR, -1*LDB_SPEED);
+    } else if (state == 1 and angle < LOAD_ANGLE) {
+      motors::move_velocity(LDB_MOTOR, 50);
+    } else if (state == 2) {
+      if (last.score) {
+        if (angle < MAX_ANGLE) {
+          motors::move_velocity(LDB_MOTOR, LDB_SPEED);
+        } else {
+          motors::brake(LDB_MOTOR);
+        }
+      } else {
+        state = 0;
+      }
+    } else {
+      motors::brake(LDB_MOTOR);
+    }
+  }
+
+  if (next) { // Toggle Lady Brown
+    if (state == -1) {
+      state = 0;
+    } else if (state == 0) {
+      state = 1;
+    } else if (state == 1) {
+      state = 2;
+    }
+  }
+  motors::flush(LDB_MOTOR);
+  if (state != ladybrown_state.latest()) ladybrown_state.send(state);
+}
+
+// Mogo clamp
+void clamp_run() {
+  int state;
+  while (clamp_command.receive(state)) {
+    mogo.set_value(state == 2);
+    clamp_state.send(state);
+  }
+}
+
+// Controller screen and rumble, one write per run so none are dropped
+void controller_run() {
+  static uint32_t seen = 0;
+  static std::deque<std::function<void()>> writes;
+
+  uint32_t count = clamp_state.count();
+  if (count != seen) {
+    seen = count;
+    int state = clamp_state.latest();
+    if (state == 0) {
+      writes.push_back([]() { master.set_text(0, 0, "Open     "); });
+    } else if (state == 1) {
+      writes.push_back([]() { master.set_text(0, 0, "Armed     "); });
+      writes.push_back([]() { master.rumble("-"); });
+    } else if (state == 2) {
+      writes.push_back([]() { master.set_text(0, 0, "Clamped"); });
+      writes.push_back([]() { master.rumble("."); });
+    }
+  }
+  if (!writes.empty()) {
+    writes.front()();
+    writes.pop_front();
+  }
+}
+}  // namespace
+
+void mechanisms_initialize() {
+  jobs::add("Lady Brown Ctrl", ez::util::DELAY_TIME, jobs::CONTROL, ladybrown_run);
+  jobs::add("Clamp", ez::util::DELAY_TIME, jobs::CONTROL, clamp_run);
+  jobs::add("Controller", CONTROLLER_PERIOD, jobs::UI, controller_run);
+}
@@ -0,0 +1,154 @@
+#include "telemetry.hpp"
+
+#include "main.h"
+
+namespace telemetry {
+namespace {
+struct channel_t {
+  std::string name;
+  std::function<double()> source;
+};
+
+pros::Mutex mutex;
+encoder codec;
+channel_t channels[CHANNELS_MAX];
+pros::Serial* serial = nullptr;
+pros::Task* task = nullptr;
+stats_t stats = {};
+
+// Token bucket, in bytes
+uint32_t budget = 4000;
+double tokens = 0;
+
+bool sink_write(uint8_t* data, size_t length) {
+  if (serial != nullptr) {
+    // Never let the serial buffer block the task, a full buffer is the same as no budget
+    if (serial->get_write_free() < (int32_t)length) return false;
+    return serial->write(data, length) == (int32_t)length;
+  }
+  bool ok = fwrite(data, 1, length, stdout) == length;
+  fflush(stdout);
+  return ok;
+}
+
+void task_loop(uint32_t period_ms) {
+  static uint8_t out[2 * ENCODED_MAX];
+  double values[CHANNELS_MAX] = {};
+  uint32_t second_start = pros::millis(), second_bytes = 0;
+  uint32_t now = pros::millis();
+
+  int job = monitor::add("Telemetry", period_ms);
+  while (true) {
+    monitor::begin(job);
+    mutex.take();
+    uint32_t mask = codec.subscribed_get();
+    for (int id = 0; id < CHANNELS_MAX; id++) {
+      if ((mask & (1u << id)) && channels[id].source) values[id] = channels[id].source();
+    }
+
+    // A frame bigger than the burst cap goes once the bucket is full and leaves it in debt,
+    // so big schema frames still go out at small budgets and the average still holds
+    double cap = budget / 5.0;
+    tokens = std::fmin(tokens + budget * period_ms / 1000.0, cap);
+    size_t length = codec.encode(pros::millis(), values, out);
+    if (length > 0 && tokens >= std::fmin((double)length, cap) && sink_write(out, length)) {
+      codec.commit();
+      tokens -= length;
+      stats.frames_sent++;
+      stats.bytes_sent += length;
+      second_bytes += length;
+    } else {
+      stats.frames_skipped++;
+    }
+
+    if (pros::millis() - second_start >= 1000) {
+      stats.bytes_per_second = second_bytes;
+      second_bytes = 0;
+      second_start = pros::millis();
+    }
+    mutex.give();
+
+    monitor::end(job);
+    pros::Task::delay_until(&now, period_ms);
+  }
+}
+
+uint32_t mask_of(std::vector<std::string> names) {
+  uint32_t mask = 0;
+  for (auto& name : names) {
+    for (int id = 0; id < CHANNELS_MAX; id++) {
+      if (channels[id].source && channels[id].name == name) mask |= 1u << id;
+    }
+  }
+  return mask;
+}
+}  // namespace
+
+void initialize() {
+  channel_add(0, "x", 0.01, []() { return tracking::pose_get().x; });
+  channel_add(1, "y", 0.01, []() { return tracking::pose_get().y; });
+  channel_add(2, "theta", 0.01, []() { return tracking::pose_get().theta; });
+  channel_add(3, "drive_error", 0.01, []() { return chassis.leftPID.error; });
+  channel_add(4, "turn_error", 0.01, []() { return chassis.turnPID.error; });
+  channel_add(5, "swing_error", 0.01, []() { return chassis.swingPID.error; });
+  channel_add(6, "heading_error", 0.01, []() { return chassis.headingPID.error; });
+  channel_add(7, "left_vel", 1, []() { return chassis.drive_velocity_left(); });
+  channel_add(8, "right_vel", 1, []() { return chassis.drive_velocity_right(); });
+  channel_add(9, "gyro_rate", 0.1, []() { return heading::rate_get(); });
+  channel_add(10, "ldb_pct", 0.1, []() { return arm::pct_get(); });  // The estimate, ldb_pct() is the rounded pot
+  channel_add(11, "battery", 0.01, []() { return pros::battery::get_voltage() / 1000.0; });
+
+  subscribe({"x", "y", "theta", "drive_error", "turn_error", "heading_error"});
+}
+
+void channel_add(uint8_t id, std::string name, float scale, std::function<double()> source) {
+  if (id >= CHANNELS_MAX) return;
+  mutex.take();
+  bool fits = codec.channel_set(id, name.c_str(), scale);
+  if (fits) channels[id] = {name, source};
+  mutex.give();
+  if (!fits) LOGE("Telemetry: channel %s (%d) doesn't fit in the schema frame, shorten the names", name, (int)id);
+}
+
+void subscribe(std::vector<std::string> names) {
+  mutex.take();
+  codec.subscribe(mask_of(names));
+  mutex.give();
+}
+
+void subscribe_all() {
+  mutex.take();
+  uint32_t mask = 0;
+  for (int id = 0; id < CHANNELS_MAX; id++) {
+    if (channels[id].source) mask |= 1u << id;
+  }
+  codec.subscribe(mask);
+  mutex.give();
+}
+
+void budget_set(uint32_t bytes_per_second) {
+  mutex.take();
+  budget = bytes_per_second;
+  mutex.give();
+}
+
+void start(int port, int baud, uint32_t period_ms) {
+  if (task != nullptr) return;
+  if (port != 0) serial = new pros::Serial(abs(port), baud);
+  task = new pros::Task([period_ms]() { task_loop(period_ms); }, jobs::priority(period_ms, jobs::UI), TASK_STACK_DEPTH_DEFAULT, "Telemetry");
+}
+
+void resync() {
+  mutex.take();
+  codec.resync();
+  mutex.give();
+}
+
+stats_t stats_get() {
+  mutex.take();
+  stats_t copy = stats;
+  mutex.give();
+  return copy;
+}
+
+}  // namespace telemetry
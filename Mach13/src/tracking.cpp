@@ -0,0 +1,56 @@
+#include "tracking.hpp"
+
+#include "main.h"
+#include "seqlock.hpp"
+
+namespace tracking {
+namespace {
+const int DELAY = ez::util::DELAY_TIME;
+const double DT = DELAY / 1000.0;
+
+pros::Task* task = nullptr;
+seqlock<state_t> published;
+
+bool same(const ez::pose& a, const ez::pose& b) { return a.x == b.x && a.y == b.y && a.theta == b.theta; }
+
+void task_loop() {
+  state_t state = {chassis.odom_pose_get(), 0.0, 0.0, pros::millis(), 0};
+  uint32_t now = pros::millis();
+  int job = monitor::add("Pose", DELAY);
+  while (true) {
+    monitor::begin(job);
+    // Below EZ-Template's priority its update has always finished, reading twice catches anything else that moves it
+    ez::pose pose = chassis.odom_pose_get();
+    for (ez::pose again = chassis.odom_pose_get(); !same(pose, again); again = chassis.odom_pose_get()) pose = again;
+
+    double dx = pose.x - state.pose.x, dy = pose.y - state.pose.y;
+    double along = dx * sin(ez::util::to_rad(pose.theta)) + dy * cos(ez::util::to_rad(pose.theta));  // theta 0 faces +y
+    double turned = pose.theta - state.pose.theta;
+    if (fabs(along) > 12.0 || fabs(turned) > 45.0) along = turned = 0.0;  // Pose was set, not driven
+    state.velocity += 0.5 * (along / DT - state.velocity);
+    state.turn_rate += 0.5 * (turned / DT - state.turn_rate);
+    state.pose = pose;
+    state.time = pros::millis();
+    state.version++;
+    published.set(state);
+    monitor::end(job);
+    pros::Task::delay_until(&now, DELAY);
+  }
+}
+}  // namespace
+
+void initialize() {
+  if (task != nullptr) return;
+  published.set({chassis.odom_pose_get(), 0.0, 0.0, pros::millis(), 0});
+  // Below EZ-Template's task on purpose, see tracking.hpp
+  task = new pros::Task(task_loop, jobs::priority(DELAY, jobs::ODOMETRY), TASK_STACK_DEPTH_DEFAULT, "Pose");
+}
+
+state_t get() {
+  if (task == nullptr) return {chassis.odom_pose_get(), 0.0, 0.0, pros::millis(), 0};
+  return published.get();
+}
+
+ez::pose pose_get() { return get().pose; }
+
+}  // namespace tracking
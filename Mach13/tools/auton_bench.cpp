@@ -0,0 +1,164 @@
+// Runs every auton thousands of times against a simulated robot to see which are fast and which are fragile
+//
+//  Build on your computer, this isn't part of the robot program:
+//    g++ -std=c++17 -O2 -pthread -Isim -I../include auton_bench.cpp ../src/autons.cpp -o auton_bench
+//  sim/main.h stands in for the robot's main.h, so the autons are the real ones, unchanged.
+//
+//  Usage:
+//    auton_bench [runs] [auton] [seed]   runs defaults to 2000, every auton unless one is named
+//
+//  Each run gets its own robot: weaker or stronger drive sides, worn wheels, a drifting and
+//  mis-scaled IMU, noisy sensors and a start that's a little off.  For each auton this prints how
+//  long it took to finish its last motion, how far it ended from where a perfect robot ends, how
+//  far it was from the perfect robot's pose when a mechanism was used, and how often motions gave
+//  up or the period ran out partway through one.  Runs are split over every core.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "main.h"
+
+thread_local sim::drive chassis;
+thread_local sim::motor ladybrown("ladybrown");
+thread_local sim::motor inveyor("inveyor");
+
+void default_constants();
+void redleft();
+void redright();
+void blueright();
+void blueleft();
+void soloawp();
+void skills();
+
+namespace {
+typedef struct auton {
+  const char* name;
+  void (*run)();
+  double period;  // ms
+} auton;
+
+// Same list as the auton selector in main.cpp
+const auton AUTONS[] = {
+    {"redleft", redleft, 15000},   {"redright", redright, 15000}, {"blueright", blueright, 15000},
+    {"blueleft", blueleft, 15000}, {"soloawp", soloawp, 15000},   {"skills", skills, 60000},
+};
+
+typedef struct result {
+  double time;         // ms to the last motion or mechanism, the whole period if one was cut off
+  double error;        // inches from the perfect robot's final position
+  double heading;      // degrees from the perfect robot's final heading
+  double event_error;  // inches, worst distance from the perfect robot's pose when a mechanism was used
+  bool cut_off;
+  int stalls;
+} result;
+
+typedef struct outcome {
+  sim::pose final;
+  std::vector<sim::pose> events;
+  double time;
+  bool cut_off;
+  int stalls;
+} outcome;
+
+sim::robot_t robot_random(uint64_t seed) {
+  std::mt19937_64 random(seed);
+  std::normal_distribution<double> normal;
+  sim::robot_t r;
+  r.strength_left = std::clamp(1.0 + 0.05 * normal(random), 0.8, 1.1);
+  r.strength_right = std::clamp(1.0 + 0.05 * normal(random), 0.8, 1.1);
+  r.wheel = sim::WHEEL * (1.0 + 0.01 * normal(random));
+  r.lag = std::max(0.03, 0.08 + 0.01 * normal(random));
+  r.imu_drift = 0.02 * normal(random);
+  r.imu_scale = 0.003 * normal(random);
+  r.encoder_noise = 0.02;
+  r.imu_noise = 0.05;
+  r.x = 0.5 * normal(random);
+  r.y = 0.5 * normal(random);
+  r.theta = 1.0 * normal(random);
+  return r;
+}
+
+outcome run_once(const auton& a, const sim::robot_t& robot, uint64_t seed) {
+  chassis.reset(robot, seed, a.period);
+  default_constants();
+  bool finished = true;
+  try {
+    a.run();
+  } catch (sim::period_over&) {
+    finished = false;
+  }
+  // A hold at the end is waiting, not working, but time running out mid motion means it never finished
+  double time = finished ? chassis.time : chassis.cut_off ? a.period : chassis.last_action;
+  return {chassis.pose_get(), chassis.events, time, chassis.cut_off, chassis.stalls};
+}
+
+double percentile(std::vector<double> v, double p) {
+  if (v.empty()) return 0;
+  std::sort(v.begin(), v.end());
+  return v[std::min(v.size() - 1, (size_t)(p * v.size()))];
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  int runs = argc > 1 ? atoi(argv[1]) : 2000;
+  const char* only = argc > 2 ? argv[2] : nullptr;
+  uint64_t seed = argc > 3 ? strtoull(argv[3], nullptr, 10) : 1;
+  int threads = std::max(1u, std::thread::hardware_concurrency());
+
+  printf("%i runs per auton on %i threads\n", runs, threads);
+  printf("%-10s %27s %27s %9s %11s %7s %7s\n", "", "time s (p5 / p50 / p95)", "final error in (p50/p95/max)", "head p95", "event p95", "cut off",
+         "stalled");
+  auto start = std::chrono::steady_clock::now();
+  for (const auton& a : AUTONS) {
+    if (only != nullptr && strcmp(only, a.name) != 0) continue;
+
+    // What a perfect robot does, every run is compared against it
+    outcome perfect;
+    std::thread([&]() { perfect = run_once(a, sim::robot_t(), seed); }).join();
+
+    std::vector<result> results(runs);
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; t++) {
+      pool.emplace_back([&, t]() {
+        for (int i = t; i < runs; i += threads) {
+          uint64_t s = seed * 1000003 + i;
+          outcome o = run_once(a, robot_random(s), s);
+          double worst = 0;
+          for (size_t e = 0; e < std::min(o.events.size(), perfect.events.size()); e++) {
+            worst = std::max(worst, std::hypot(o.events[e].x - perfect.events[e].x, o.events[e].y - perfect.events[e].y));
+          }
+          results[i] = {o.time,
+                        std::hypot(o.final.x - perfect.final.x, o.final.y - perfect.final.y),
+                        fabs(std::remainder(o.final.theta - perfect.final.theta, 360.0)),
+                        worst,
+                        o.cut_off,
+                        o.stalls};
+        }
+      });
+    }
+    for (auto& t : pool) t.join();
+
+    std::vector<double> time, error, heading, event;
+    int cut = 0, stalled = 0;
+    for (auto& r : results) {
+      time.push_back(r.time / 1000.0);
+      error.push_back(r.error);
+      heading.push_back(r.heading);
+      event.push_back(r.event_error);
+      cut += r.cut_off;
+      stalled += r.stalls > 0;
+    }
+    printf("%-10s %8.2f /%7.2f /%7.2f %9.2f /%6.2f /%7.2f %9.1f %11.2f %6.1f%% %6.1f%%\n", a.name, percentile(time, 0.05), percentile(time, 0.5),
+           percentile(time, 0.95), percentile(error, 0.5), percentile(error, 0.95), percentile(error, 1.0), percentile(heading, 0.95),
+           percentile(event, 0.95), 100.0 * cut / runs, 100.0 * stalled / runs);
+    if (perfect.cut_off || perfect.stalls > 0) {
+      printf("%-10s even a perfect robot %s\n", "", perfect.cut_off ? "runs out of time partway through a motion" : "has a motion give up");
+    }
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  printf("%.2fs\n", seconds);
+  return 0;
+}
@@ -0,0 +1,338 @@
+// Looks for a faster way to drive an auton's motions without changing where its mechanisms are used
+//
+//  Build on your computer, this isn't part of the robot program:
+//    g++ -std=c++17 -O2 -pthread -Isim -I../include auton_optimize.cpp ../src/autons.cpp -o auton_optimize
+//  sim/main.h stands in for the robot's main.h, the same as auton_bench.
+//
+//  Usage:
+//    auton_optimize <auton> [runs]   runs is how many random robots check each candidate, defaults to 64
+//
+//  The auton is run once on the simulated robot (sim/main.h) and every command is recorded.
+//  Mechanism calls and delays are anchors: the robot has to be where the original put it, facing
+//  the same way, when it gets to one.  The motions between two anchors are a segment, and each
+//  segment is searched in order for something faster that ends within 1in and 3 degrees of the
+//  original:
+//    - faster motions, and pid_wait_quick_chain() between motions that don't end at an anchor
+//    - a boomerang move (pid_odom_set with an angle) in place of the turns around a drive, which
+//      drives one arc instead of turn, stop, drive, stop, turn.  Every drive still ends where it
+//      did, since the intake may be picking something up there
+//  The last motion before a mechanism keeps its speed and full stop, since how the robot arrives
+//  matters as much as where.  A candidate also has to be no less repeatable than the original
+//  across random robots (auton_bench's variation).  The faster auton is printed as code with the
+//  time each change saves.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+#include "main.h"
+
+thread_local sim::drive chassis;
+thread_local sim::motor ladybrown("ladybrown");
+thread_local sim::motor inveyor("inveyor");
+
+void default_constants();
+void redleft();
+void redright();
+void blueright();
+void blueleft();
+void soloawp();
+void skills();
+
+namespace {
+const double POSITION_TOLERANCE = 1.0;  // inches from the original at the end of a segment
+const double HEADING_TOLERANCE = 3.0;   // degrees
+const double SPREAD_ALLOWANCE = 0.5;    // inches a candidate's p95 error may exceed the original's
+const int SPEED_LEVELS[] = {90, 110, 127};
+
+typedef struct auton {
+  const char* name;
+  void (*run)();
+  double period;  // ms
+} auton;
+
+// Same list as the auton selector in main.cpp
+const auton AUTONS[] = {
+    {"redleft", redleft, 15000},   {"redright", redright, 15000}, {"blueright", blueright, 15000},
+    {"blueleft", blueleft, 15000}, {"soloawp", soloawp, 15000},   {"skills", skills, 60000},
+};
+
+typedef std::vector<sim::step> steps;
+
+typedef struct segment {
+  size_t first, last;  // motion steps, inclusive, in the recording
+  bool fixed;          // something in it can't be moved around
+} segment;
+
+typedef struct played {
+  double time;  // ms when the last step finished
+  sim::pose pose;
+  bool finished;
+} played;
+
+bool is_motion(const sim::step& s) { return s.kind <= sim::STEP_ODOM; }
+
+// Runs steps on the current thread's robot
+played play(const steps& list, const sim::robot_t& robot, uint64_t seed, double period) {
+  chassis.reset(robot, seed, period);
+  default_constants();
+  try {
+    for (const sim::step& s : list) {
+      switch (s.kind) {
+        case sim::STEP_DRIVE: chassis.pid_drive_set(s.target, s.speed, s.slew); break;
+        case sim::STEP_TURN: chassis.pid_turn_set(s.target, s.speed, s.slew); break;
+        case sim::STEP_SWING: chassis.pid_swing_set((ez::e_swing)s.side, s.target, s.speed, s.opposite, s.slew); break;
+        case sim::STEP_ODOM:
+          chassis.pid_odom_set({{s.to.x, s.to.y, s.to.theta}, s.reverse ? ez::REV : ez::FWD, s.speed}, s.slew);
+          break;
+        case sim::STEP_DELAY: chassis.delay(s.target); break;
+        case sim::STEP_MECHANISM: chassis.action(s.code, s.target); break;
+        case sim::STEP_WAIT_UNTIL: chassis.pid_wait_until(s.target); break;
+        case sim::STEP_SPEED_MAX: chassis.pid_speed_max_set(s.speed); break;
+      }
+      if (s.wait == sim::WAIT_SETTLE) chassis.pid_wait();
+      if (s.wait == sim::WAIT_CHAIN) chassis.pid_wait_quick_chain();
+    }
+  } catch (sim::period_over&) {
+    return {period, chassis.pose_get(), false};
+  }
+  return {chassis.time, chassis.pose_get(), true};
+}
+
+sim::robot_t robot_random(uint64_t seed) {
+  std::mt19937_64 random(seed);
+  std::normal_distribution<double> normal;
+  sim::robot_t r;
+  r.strength_left = std::clamp(1.0 + 0.05 * normal(random), 0.8, 1.1);
+  r.strength_right = std::clamp(1.0 + 0.05 * normal(random), 0.8, 1.1);
+  r.wheel = sim::WHEEL * (1.0 + 0.01 * normal(random));
+  r.lag = std::max(0.03, 0.08 + 0.01 * normal(random));
+  r.imu_drift = 0.02 * normal(random);
+  r.imu_scale = 0.003 * normal(random);
+  r.encoder_noise = 0.02;
+  r.imu_noise = 0.05;
+  r.x = 0.5 * normal(random);
+  r.y = 0.5 * normal(random);
+  r.theta = 1.0 * normal(random);
+  return r;
+}
+
+// 95th percentile distance from a pose across random robots, split over every core
+double spread(const steps& list, const sim::pose& goal, double period, int runs) {
+  int threads = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<double> errors(runs);
+  std::vector<std::thread> pool;
+  for (int t = 0; t < threads; t++) {
+    pool.emplace_back([&, t]() {
+      for (int i = t; i < runs; i += threads) {
+        played p = play(list, robot_random(7919 + i), 7919 + i, period);
+        errors[i] = p.finished ? std::hypot(p.pose.x - goal.x, p.pose.y - goal.y) : 1e9;
+      }
+    });
+  }
+  for (auto& t : pool) t.join();
+  std::sort(errors.begin(), errors.end());
+  return errors[std::min((size_t)runs - 1, (size_t)(0.95 * runs))];
+}
+
+// The step as it would be written in autons.cpp, with its wait after separator
+std::string code(const sim::step& s, const char* separator = "\n  ") {
+  char text[160];
+  switch (s.kind) {
+    case sim::STEP_DRIVE: snprintf(text, sizeof(text), "chassis.pid_drive_set(%g_in, %i%s);", s.target, s.speed, s.slew ? ", true" : ""); break;
+    case sim::STEP_TURN: snprintf(text, sizeof(text), "chassis.pid_turn_set(%g_deg, %i);", s.target, s.speed); break;
+    case sim::STEP_SWING:
+      snprintf(text, sizeof(text), "chassis.pid_swing_set(ez::%s, %g_deg, %i, %i);", s.side == ez::LEFT_SWING ? "LEFT_SWING" : "RIGHT_SWING",
+               s.target, s.speed, s.opposite);
+      break;
+    case sim::STEP_ODOM:
+      snprintf(text, sizeof(text), "chassis.pid_odom_set({{%.1f_in, %.1f_in, %.1f_deg}, %s, %i}%s);", s.to.x, s.to.y, s.to.theta,
+               s.reverse ? "rev" : "fwd", s.speed, s.slew ? ", true" : "");
+      break;
+    case sim::STEP_DELAY: snprintf(text, sizeof(text), "pros::delay(%.0f);", s.target); break;
+    case sim::STEP_MECHANISM: snprintf(text, sizeof(text), "%s;", s.code.c_str()); break;
+    case sim::STEP_WAIT_UNTIL: snprintf(text, sizeof(text), "chassis.pid_wait_until(%g_in);", s.target); break;
+    case sim::STEP_SPEED_MAX: snprintf(text, sizeof(text), "chassis.pid_speed_max_set(%i);", s.speed); break;
+  }
+  std::string out = text;
+  if (s.wait == sim::WAIT_SETTLE) out += separator + std::string("chassis.pid_wait();");
+  if (s.wait == sim::WAIT_CHAIN) out += separator + std::string("chassis.pid_wait_quick_chain();");
+  return out;
+}
+
+// The original motions sped up, chained where nothing needs the robot stopped
+steps faster(const steps& motions, int level, bool chain, bool keep_last) {
+  steps out = motions;
+  for (size_t i = 0; i < out.size(); i++) {
+    bool last = i + 1 == out.size();
+    if (last && keep_last) continue;
+    out[i].speed = std::max(out[i].speed, level);
+    if (chain && !last) out[i].wait = sim::WAIT_CHAIN;
+  }
+  return out;
+}
+
+// Every way to drive a segment that's worth simulating
+//  Motions carry where they ended in the recording in .to, so boomerang targets survive earlier changes
+std::vector<steps> candidates(const steps& motions, bool keep_last) {
+  std::vector<steps> out;
+  for (int level : SPEED_LEVELS) {
+    out.push_back(faster(motions, level, false, keep_last));
+    if (motions.size() > 1) out.push_back(faster(motions, level, true, keep_last));
+  }
+
+  // Turns around one drive become a single boomerang move to where the last of them ended.  Every
+  //  drive still ends where it did, the intake may be picking something up there
+  size_t end = keep_last ? motions.size() - 1 : motions.size();  // The approach stays as it is
+  for (size_t i = 0; i < end; i++) {
+    for (size_t j = i + 1; j < end; j++) {
+      int drives = 0;
+      bool reverse = false;
+      for (size_t k = i; k <= j; k++) {
+        if (motions[k].kind == sim::STEP_DRIVE || motions[k].kind == sim::STEP_ODOM) drives++;
+        if (motions[k].kind == sim::STEP_DRIVE) reverse = motions[k].target < 0;
+        if (motions[k].kind == sim::STEP_ODOM) reverse = motions[k].reverse;
+      }
+      if (drives != 1) continue;
+      for (int level : SPEED_LEVELS) {
+        sim::step move = {sim::STEP_ODOM};
+        move.to = motions[j].to;
+        move.reverse = reverse;
+        move.speed = level;
+        move.wait = j + 1 < motions.size() ? sim::WAIT_CHAIN : sim::WAIT_SETTLE;
+        steps list(motions.begin(), motions.begin() + i);
+        list.push_back(move);
+        list.insert(list.end(), motions.begin() + j + 1, motions.end());
+        out.push_back(list);
+      }
+    }
+  }
+  return out;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: auton_optimize <auton> [runs]\n");
+    return 2;
+  }
+  int runs = argc > 2 ? atoi(argv[2]) : 64;
+  const auton* a = nullptr;
+  for (const auton& candidate : AUTONS) {
+    if (strcmp(candidate.name, argv[1]) == 0) a = &candidate;
+  }
+  if (a == nullptr) {
+    fprintf(stderr, "no auton named %s\n", argv[1]);
+    return 2;
+  }
+  auto start = std::chrono::steady_clock::now();
+
+  // Record what the auton does on a perfect robot, with the pose after every step
+  steps original;
+  chassis.reset(sim::robot_t(), 1, a->period);
+  chassis.recording = &original;
+  default_constants();
+  bool finished = true;
+  try {
+    a->run();
+  } catch (sim::period_over&) {
+    finished = false;
+  }
+  bool cut_off = chassis.cut_off;  // Rather than holding still in a long delay at the end
+  chassis.recording = nullptr;
+  std::vector<double> times;
+  for (size_t i = 0; i < original.size(); i++) {
+    played p = play(steps(original.begin(), original.begin() + i + 1), sim::robot_t(), 1, a->period);
+    if (is_motion(original[i])) original[i].to = p.pose;
+    times.push_back(p.finished ? p.time : a->period);
+  }
+  size_t usable = original.size();
+  if (!finished) {
+    // The last step never finished, so there's nothing to match after it
+    while (usable > 0 && times[usable - 1] >= a->period) usable--;
+    if (cut_off) {
+      printf("%s runs out of time partway through step %zu: %s\nFix that first, only the steps before it are optimized.\n\n", a->name,
+             usable + 1, code(original[usable], " ").c_str());
+    }
+  }
+
+  // Split into segments of motions between anchors
+  std::vector<segment> segments;
+  for (size_t i = 0; i < usable; i++) {
+    if (!is_motion(original[i])) continue;
+    size_t j = i;
+    bool fixed = false;
+    while (j + 1 < usable && (is_motion(original[j + 1]) || original[j + 1].kind >= sim::STEP_WAIT_UNTIL)) {
+      j++;
+      fixed = fixed || !is_motion(original[j]);
+    }
+    segments.push_back({i, j, fixed || original[j].wait == sim::WAIT_NONE});
+    i = j;
+  }
+
+  // Greedy, one segment at a time in order, keeping what was chosen for the ones before
+  steps chosen(original.begin(), original.begin() + (segments.empty() ? usable : segments[0].first));
+  double saved_total = 0;
+  for (size_t k = 0; k < segments.size(); k++) {
+    const segment& seg = segments[k];
+    steps motions(original.begin() + seg.first, original.begin() + seg.last + 1);
+    sim::pose goal = original[seg.last].to;
+    bool before_mechanism = seg.last + 1 < usable && original[seg.last + 1].kind == sim::STEP_MECHANISM;
+
+    steps baseline = chosen;
+    baseline.insert(baseline.end(), motions.begin(), motions.end());
+    played base = play(baseline, sim::robot_t(), 1, a->period);
+    steps original_prefix(original.begin(), original.begin() + seg.last + 1);
+    double allowed = std::max(POSITION_TOLERANCE, spread(original_prefix, goal, a->period, runs)) + SPREAD_ALLOWANCE;
+
+    // Keep taking the fastest candidate that still arrives, until none is faster
+    steps best = motions;
+    double best_time = base.time;
+    for (bool improved = !seg.fixed; improved;) {
+      improved = false;
+      steps current = best;
+      for (const steps& c : candidates(current, before_mechanism)) {
+        steps trial = chosen;
+        trial.insert(trial.end(), c.begin(), c.end());
+        played p = play(trial, sim::robot_t(), 1, a->period);
+        if (!p.finished || p.time >= best_time - 20) continue;  // Not worth a change under 20ms
+        if (std::hypot(p.pose.x - goal.x, p.pose.y - goal.y) > POSITION_TOLERANCE) continue;
+        if (fabs(std::remainder(p.pose.theta - goal.theta, 360.0)) > HEADING_TOLERANCE) continue;
+        if (spread(trial, goal, a->period, runs) > allowed) continue;
+        best = c;
+        best_time = p.time;
+        improved = true;
+      }
+    }
+
+    double saved = base.time - best_time;
+    saved_total += saved;
+    if (saved > 0) {
+      printf("// Steps %zu-%zu save %.2fs:\n", seg.first + 1, seg.last + 1, saved / 1000.0);
+      for (auto& s : motions) printf("//   was %s\n", code(s, " ").c_str());
+    }
+    chosen.insert(chosen.end(), best.begin(), best.end());
+    size_t next = k + 1 < segments.size() ? segments[k + 1].first : original.size();
+    chosen.insert(chosen.end(), original.begin() + seg.last + 1, original.begin() + next);
+  }
+  if (segments.empty()) chosen = original;
+
+  // How long each takes to get through its last motion or mechanism, the same as auton_bench
+  auto work_time = [&](const steps& list) {
+    played p = play(list, sim::robot_t(), 1, a->period);
+    return p.finished ? p.time : chassis.cut_off ? a->period : chassis.last_action;
+  };
+  double before = work_time(original), after = work_time(chosen);
+
+  bool odom = false;
+  for (auto& s : chosen) odom = odom || s.kind == sim::STEP_ODOM;
+  printf("\nvoid %s() {\n", a->name);
+  if (odom) printf("  chassis.odom_xyt_set(0_in, 0_in, 0_deg);  // Boomerang moves are relative to where the auton starts\n");
+  for (auto& s : chosen) printf("  %s\n", code(s).c_str());
+  printf("}\n\n");
+  printf("%s: %.2fs -> %.2fs on a perfect robot, %.2fs saved\n", a->name, before / 1000.0, after / 1000.0, saved_total / 1000.0);
+  printf("searched in %.1fs\n", std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+  return 0;
+}
@@ -0,0 +1,168 @@
+// Decodes the robot's binary log (see include/logging.hpp) into text
+//
+//  Build on your computer, this isn't part of the robot program:
+//    g++ -std=c++17 -O2 -I../include log_decode.cpp -o log_decode
+//
+//  Usage:
+//    log_decode /dev/ttyACM1 [baud]   read the terminal after logging::terminal_set(level, true)
+//    log_decode m13_log.bin           read a log copied off the SD card
+//    log_decode -                     read stdin
+//
+//  Each record is printed as its time in seconds, level, file:line and message.  Records that
+//  arrive before their format (joining a terminal stream partway) are counted and skipped.
+//  Decode counters are printed to stderr on exit.
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+
+#include "log_codec.hpp"
+
+namespace {
+volatile sig_atomic_t running = 1;
+
+typedef struct format_info {
+  uint8_t level;
+  uint32_t line;
+  std::string file;
+  std::string text;
+} format_info;
+
+typedef struct counters {
+  uint32_t frames, bad_frames, gaps, unknown, lost;
+} counters;
+
+std::map<uint32_t, format_info> formats;
+counters stats = {};
+bool have_seq = false;
+uint8_t last_seq = 0;
+
+speed_t baud_of(int baud) {
+  switch (baud) {
+    case 9600: return B9600;
+    case 19200: return B19200;
+    case 38400: return B38400;
+    case 57600: return B57600;
+    case 230400: return B230400;
+    case 460800: return B460800;
+    case 921600: return B921600;
+    default: return B115200;
+  }
+}
+
+// Raw mode so the terminal driver doesn't eat 0x00 delimiters or translate line endings
+bool tty_configure(int fd, int baud) {
+  termios tty;
+  if (tcgetattr(fd, &tty) != 0) return false;
+  cfmakeraw(&tty);
+  cfsetispeed(&tty, baud_of(baud));
+  cfsetospeed(&tty, baud_of(baud));
+  tty.c_cc[VMIN] = 1;
+  tty.c_cc[VTIME] = 0;
+  return tcsetattr(fd, TCSANOW, &tty) == 0;
+}
+
+void frame_handle(const uint8_t* encoded, size_t length) {
+  uint8_t raw[telemetry::FRAME_MAX + 8];
+  if (length == 0 || length > sizeof(raw)) return;
+  size_t size = telemetry::cobs_decode(encoded, length, raw);
+  if (size < 4 || crc::crc16(raw, size - 2) != (uint16_t)((raw[size - 2] << 8) | raw[size - 1])) {
+    stats.bad_frames++;
+    return;
+  }
+  stats.frames++;
+  telemetry::frame_reader frame(raw, size - 2);
+  uint8_t type = frame.u8();
+  uint8_t seq = frame.u8();
+  if (have_seq && seq != (uint8_t)(last_seq + 1)) stats.gaps++;
+  have_seq = true;
+  last_seq = seq;
+
+  switch (type) {
+    case logging::FRAME_FORMAT: {
+      uint32_t id = frame.varint();
+      format_info f;
+      f.level = frame.u8();
+      f.line = frame.varint();
+      f.file = logging::string_read(frame);
+      f.text = logging::string_read(frame);
+      if (frame.ok) formats[id] = f;
+      break;
+    }
+    case logging::FRAME_RECORD: {
+      uint32_t id = frame.varint();
+      uint32_t time = frame.varint();
+      auto f = formats.find(id);
+      if (!frame.ok || f == formats.end()) {
+        stats.unknown++;
+        break;
+      }
+      std::string text = logging::render(f->second.text.c_str(), frame);
+      printf("%9.3f  %-5s  %s:%u  %s\n", time / 1000.0, logging::level_name(f->second.level), f->second.file.c_str(), f->second.line,
+             text.c_str());
+      break;
+    }
+    case logging::FRAME_LOST: {
+      uint32_t records = frame.varint();
+      stats.lost += records;
+      printf("          ...  %u records dropped on the robot\n", records);
+      break;
+    }
+    default:
+      stats.bad_frames++;
+  }
+  fflush(stdout);
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <device|file|-> [baud]\n", argv[0]);
+    return 2;
+  }
+
+  int fd = strcmp(argv[1], "-") == 0 ? STDIN_FILENO : open(argv[1], O_RDONLY | O_NOCTTY);
+  if (fd < 0) {
+    perror(argv[1]);
+    return 1;
+  }
+  if (isatty(fd) && !tty_configure(fd, argc > 2 ? atoi(argv[2]) : 115200)) {
+    perror("tcsetattr");
+    return 1;
+  }
+  signal(SIGINT, [](int) { running = 0; });
+
+  // Frames end at 0x00, anything between them that doesn't decode is dropped
+  uint8_t buffer[512], pending[telemetry::ENCODED_MAX];
+  size_t pending_length = 0;
+  bool overflow = false;
+  while (running) {
+    ssize_t length = read(fd, buffer, sizeof(buffer));
+    if (length <= 0) break;
+    for (ssize_t i = 0; i < length; i++) {
+      if (buffer[i] == 0x00) {
+        if (overflow)
+          stats.bad_frames++;
+        else
+          frame_handle(pending, pending_length);
+        pending_length = 0;
+        overflow = false;
+      } else if (pending_length < sizeof(pending)) {
+        pending[pending_length++] = buffer[i];
+      } else {
+        overflow = true;
+      }
+    }
+  }
+
+  fprintf(stderr, "frames %u, bad %u, gaps %u, without a format %u, dropped on the robot %u\n", stats.frames, stats.bad_frames, stats.gaps,
+          stats.unknown, stats.lost);
+  if (fd != STDIN_FILENO) close(fd);
+  return 0;
+}
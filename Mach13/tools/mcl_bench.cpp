@@ -0,0 +1,171 @@
+// Benchmarks and checks the particle filter (see include/mcl.hpp) against a simulated robot
+//
+//  Build on your computer, this isn't part of the robot program:
+//    g++ -std=c++17 -O2 -I../include mcl_bench.cpp -o mcl_bench
+//
+//  Usage:
+//    mcl_bench [particles] [seed]   particles defaults to 300
+//
+//  A robot drives laps of the field with drifting odometry and four noisy distance sensors.
+//  Each scenario prints whether the filter ended up where the robot really is, then the time per
+//  update is printed.  Exits 1 if any scenario fails.  The brain is roughly 10 to 20 times slower
+//  than a desktop core, so keep a desktop update well under 0.3ms to stay within a few ms there.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+
+#include "mcl.hpp"
+
+namespace {
+const double DT = 0.05;  // seconds per update, the robot runs it every 50ms
+const double SPEED = 30.0;
+
+struct sim {
+  mcl::field_map map = mcl::field_map::high_stakes();
+  std::vector<mcl::mount> mounts = {{0, 7, 0, 78}, {0, -7, 180, 78}, {-7, 0, -90, 78}, {7, 0, 90, 78}};
+  mcl::rng random;
+  mcl::pose truth = {-48, -48, 0};
+  mcl::pose odom = {-48, -48, 0};  // What odometry thinks, in the field frame
+  double odom_scale = 1.03;        // Wheels a little bigger than configured
+  double gyro_drift = 0.3;         // deg/s
+  int waypoint = 0;
+
+  explicit sim(uint64_t seed) : random(seed) {}
+
+  // Laps around the ladder
+  void step(double& forward, double& right, double& turn) {
+    static const double lap[][2] = {{-48, 48}, {48, 48}, {48, -48}, {-48, -48}};
+    double tx = lap[waypoint][0], ty = lap[waypoint][1];
+    if (std::hypot(tx - truth.x, ty - truth.y) < 6.0) waypoint = (waypoint + 1) % 4;
+    double want = std::atan2(tx - truth.x, ty - truth.y) * 180.0 / M_PI;
+    double error = std::remainder(want - truth.theta, 360.0);
+    double true_turn = std::clamp(error, -180.0 * DT, 180.0 * DT);
+    double true_forward = SPEED * DT * std::max(0.0, std::cos(error * M_PI / 180.0));
+
+    double mid = (truth.theta + true_turn / 2) * M_PI / 180.0;
+    truth.x += true_forward * std::sin(mid);
+    truth.y += true_forward * std::cos(mid);
+    truth.theta += true_turn;
+
+    // Odometry sees the motion scaled, noisy and with a drifting gyro
+    forward = true_forward * odom_scale + 0.02 * random.normal();
+    right = 0.02 * random.normal();
+    turn = true_turn + gyro_drift * DT + 0.05 * random.normal();
+    double omid = (odom.theta + turn / 2) * M_PI / 180.0;
+    odom.x += forward * std::sin(omid) + right * std::cos(omid);
+    odom.y += forward * std::cos(omid) - right * std::sin(omid);
+    odom.theta += turn;
+  }
+
+  // What the distance sensors would read from the true pose
+  std::vector<double> read() {
+    std::vector<double> ranges;
+    for (auto& m : mounts) {
+      double h = truth.theta * M_PI / 180.0, a = (truth.theta + m.theta) * M_PI / 180.0;
+      float ox = truth.x + m.x * std::cos(h) + m.y * std::sin(h);
+      float oy = truth.y - m.x * std::sin(h) + m.y * std::cos(h);
+      float dx = std::sin(a), dy = std::cos(a), out;
+      mcl::cast(map, 1, &ox, &oy, &dx, &dy, &out, 200.0f);
+      double z = out + (0.3 + 0.03 * out) * random.normal();
+      if (random.uniform() < 0.05) z = random.uniform() * out;  // Another robot in the way
+      if (random.uniform() < 0.05 || z > m.max_range) z = -1;    // Nothing seen
+      ranges.push_back(z);
+    }
+    return ranges;
+  }
+};
+
+double error_of(const mcl::pose& a, const mcl::pose& b) { return std::hypot(a.x - b.x, a.y - b.y); }
+
+struct result {
+  bool pass;
+  double filter_error;
+  double odom_error;
+  double update_us;
+};
+
+// Runs seconds of driving, calling event at each step so scenarios can interfere
+result run(int particles, uint64_t seed, double seconds, double pass_error, std::function<void(sim&, mcl::filter&, int)> setup) {
+  sim s(seed);
+  mcl::constants_t c;
+  c.particles = particles;
+  mcl::filter f(s.map, s.mounts, c, seed * 7 + 1);
+  f.reset(s.truth, 1.0, 1.0);
+  double total_us = 0;
+  int steps = seconds / DT;
+  for (int i = 0; i < steps; i++) {
+    setup(s, f, i);
+    double forward, right, turn;
+    s.step(forward, right, turn);
+    std::vector<double> ranges = s.read();
+    auto start = std::chrono::steady_clock::now();
+    f.predict(forward, right, turn);
+    f.update(ranges.data());
+    total_us += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+  }
+  double filter_error = error_of(f.estimate(), s.truth);
+  return {filter_error < pass_error, filter_error, error_of(s.odom, s.truth), total_us / steps};
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  int particles = argc > 1 ? atoi(argv[1]) : 300;
+  uint64_t seed = argc > 2 ? strtoull(argv[2], nullptr, 10) : 1;
+
+  struct scenario {
+    const char* name;
+    double seconds;
+    double pass_error;
+    std::function<void(sim&, mcl::filter&, int)> setup;
+  };
+  std::vector<scenario> scenarios = {
+      {"tracking with drifting odometry", 60, 3.0, [](sim&, mcl::filter&, int) {}},
+      {"bad start, 15in off", 20, 3.0,
+       [](sim& s, mcl::filter& f, int i) {
+         if (i == 0) f.reset({s.truth.x + 12, s.truth.y - 9, s.truth.theta}, 10.0, 2.0);
+       }},
+      {"pushed 30in mid run", 40, 4.0,
+       [](sim& s, mcl::filter&, int i) {
+         if (i == 200) {
+           s.truth.x = std::clamp(s.truth.x + 30, -60.0, 60.0);  // Odometry never sees it
+           s.truth.y = std::clamp(s.truth.y - 12, -60.0, 60.0);
+         }
+       }},
+      {"global relocalization", 30, 4.0,
+       [](sim& s, mcl::filter& f, int i) {
+         if (i == 0) f.reset_global(s.truth.theta);
+       }},
+  };
+
+  int failed = 0;
+  double worst_us = 0;
+  for (auto& sc : scenarios) {
+    result r = run(particles, seed, sc.seconds, sc.pass_error, sc.setup);
+    printf("%-34s %s  filter %5.2fin  odometry alone %5.2fin  %6.1fus per update\n", sc.name, r.pass ? "PASS" : "FAIL", r.filter_error,
+           r.odom_error, r.update_us);
+    failed += !r.pass;
+    worst_us = std::max(worst_us, r.update_us);
+  }
+
+  // The ray cast on its own, every particle times every sensor
+  mcl::field_map map = mcl::field_map::high_stakes();
+  int rays = particles * 4;
+  std::vector<float> ox(rays), oy(rays), dx(rays), dy(rays), out(rays);
+  mcl::rng random(seed);
+  for (int i = 0; i < rays; i++) {
+    ox[i] = (random.uniform() * 2 - 1) * 60;
+    oy[i] = (random.uniform() * 2 - 1) * 60;
+    double a = random.uniform() * 2 * M_PI;
+    dx[i] = std::sin(a);
+    dy[i] = std::cos(a);
+  }
+  const int REPEATS = 2000;
+  auto start = std::chrono::steady_clock::now();
+  for (int k = 0; k < REPEATS; k++) mcl::cast(map, rays, ox.data(), oy.data(), dx.data(), dy.data(), out.data(), 200.0f);
+  double cast_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / REPEATS;
+  printf("ray cast: %i rays x %zu segments in %.1fus (%.1fns per ray-segment)\n", rays, map.segments.size(), cast_us,
+         1000.0 * cast_us / (rays * map.segments.size()));
+  printf("%i particles, worst scenario %.1fus per update, %i of %zu scenarios failed\n", particles, worst_us, failed, scenarios.size());
+  return failed ? 1 : 0;
+}
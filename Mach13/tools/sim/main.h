@@ -0,0 +1,548 @@
+#pragma once
+
+// Stands in for include/main.h when src/autons.cpp is built into a host tool (see auton_bench.cpp)
+//  Only what the autons call is here.  chassis is a simulated differential drive running the same
+//  PID, slew and exit conditions EZ-Template does, closely enough to compare routes, and every
+//  global is thread_local so each thread runs its own robot.  pros::delay() and pid_wait() step the
+//  simulation instead of sleeping, so a 15 second auton runs in well under a millisecond.
+//  Every command can also be recorded as a list of steps and played back (auton_optimize.cpp).
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace okapi {
+typedef struct QLength {
+  double in;
+} QLength;
+typedef struct QAngle {
+  double deg;
+} QAngle;
+typedef struct QTime {
+  double ms;
+} QTime;
+constexpr QLength operator-(QLength a) { return {-a.in}; }
+constexpr QAngle operator-(QAngle a) { return {-a.deg}; }
+
+namespace literals {
+constexpr QLength operator""_in(long double v) { return {(double)v}; }
+constexpr QLength operator""_in(unsigned long long v) { return {(double)v}; }
+constexpr QAngle operator""_deg(long double v) { return {(double)v}; }
+constexpr QAngle operator""_deg(unsigned long long v) { return {(double)v}; }
+constexpr QTime operator""_ms(long double v) { return {(double)v}; }
+constexpr QTime operator""_ms(unsigned long long v) { return {(double)v}; }
+}  // namespace literals
+}  // namespace okapi
+using namespace okapi::literals;
+
+namespace ez {
+enum e_swing { LEFT_SWING = 0, RIGHT_SWING = 1 };
+enum drive_directions { FWD = 0, fwd = FWD, REV = 1, rev = REV };
+typedef struct pose {
+  double x;
+  double y;
+  double theta;
+} pose;
+typedef struct odom {
+  pose target;
+  drive_directions drive_direction;
+  int max_xy_speed;
+} odom;
+}  // namespace ez
+
+namespace sim {
+const int DELAY = 10;  // ms, EZ-Template's loop
+const double DT = DELAY / 1000.0;
+const double WHEEL = 3.25;  // inches, what the program is configured with
+const double RPM = 450.0;
+const double TRACK = 12.0;         // inches between the wheels
+const double BOOMERANG_LEAD = 0.5;  // share of the distance the carrot point sits behind the target
+const double BOOMERANG_SETTLE = 6.0;  // inches, closer than this and boomerang holds the target heading
+
+/**
+ * Struct for what differs from one run to the next.
+ */
+typedef struct robot_t {
+  double strength_left = 1.0;   // share of nominal top speed each side reaches
+  double strength_right = 1.0;
+  double wheel = WHEEL;         // inches, the real diameter
+  double lag = 0.08;            // seconds, how quickly the wheels reach a new speed
+  double imu_drift = 0.0;       // deg/s
+  double imu_scale = 0.0;       // share of each turn the IMU over reads
+  double encoder_noise = 0.0;   // inches
+  double imu_noise = 0.0;       // degrees
+  double x = 0, y = 0, theta = 0;  // start pose, inches and degrees, theta 0 faces +y
+} robot_t;
+
+/**
+ * Struct for a pose.
+ */
+typedef struct pose {
+  double x;
+  double y;
+  double theta;
+} pose;
+
+/**
+ * Thrown when the period's time runs out, to stop the auton wherever it is.
+ */
+struct period_over {};
+
+/**
+ * Enum for recorded commands.
+ */
+enum e_step { STEP_DRIVE = 0,
+              STEP_TURN = 1,       // to an absolute heading, relative turns are recorded this way too
+              STEP_SWING = 2,
+              STEP_ODOM = 3,       // boomerang to a pose
+              STEP_DELAY = 4,
+              STEP_MECHANISM = 5,  // anything that isn't the drive, played back by its code
+              STEP_WAIT_UNTIL = 6,
+              STEP_SPEED_MAX = 7 };
+
+/**
+ * Enum for how a motion was waited on.
+ */
+enum e_wait { WAIT_NONE = 0,
+              WAIT_SETTLE = 1,  // pid_wait()
+              WAIT_CHAIN = 2 };  // pid_wait_quick_chain()
+
+/**
+ * Struct for one recorded command.
+ */
+typedef struct step {
+  e_step kind;
+  double target = 0;   // inches for drives and waits, absolute degrees for turns and swings, ms for delays and mechanism dwells
+  int speed = 0;
+  int opposite = 0;    // swings, speed of the other side
+  int side = 0;        // swings, ez::e_swing
+  bool slew = false;
+  bool reverse = false;  // boomerang
+  pose to = {0, 0, 0};   // boomerang target, or where the motion ended when it was recorded
+  e_wait wait = WAIT_NONE;
+  std::string code;      // mechanisms, as written in the auton
+} step;
+
+// Same shape as EZ-Template's PID, derivative and integral per iteration rather than per second
+struct pid {
+  double kp = 0, ki = 0, kd = 0, start_i = 0;
+  double target = 0, error = 0, last_error = 0, integral = 0;
+
+  void constants_set(double p, double i, double d, double s = 0) {
+    kp = p;
+    ki = i;
+    kd = d;
+    start_i = s;
+  }
+
+  double compute(double current) { return compute_error(target - current); }
+
+  double compute_error(double e) {
+    error = e;
+    if (ki != 0 && (start_i == 0 || fabs(error) < start_i)) integral += error;
+    if ((error > 0) != (last_error > 0)) integral = 0;
+    double out = kp * error + ki * integral + kd * (error - last_error);
+    last_error = error;
+    return out;
+  }
+
+  void reset(double new_target, double current) {
+    target = new_target;
+    error = last_error = new_target - current;
+    integral = 0;
+  }
+};
+
+// EZ-Template's exit conditions, small and big error windows plus a timeout for not moving
+struct exit_condition {
+  double small_time = 80, small_error = 1, big_time = 250, big_error = 3, velocity_time = 500;
+  double small_timer = 0, big_timer = 0, velocity_timer = 0, last_error = 0;
+
+  void set(double st, double se, double bt, double be, double vt) {
+    small_time = st;
+    small_error = se;
+    big_time = bt;
+    big_error = be;
+    velocity_time = vt;
+  }
+
+  void reset() { small_timer = big_timer = velocity_timer = 0; }
+
+  // 0 running, 1 settled, 2 gave up because it stopped moving
+  int check(double error) {
+    small_timer = fabs(error) < small_error ? small_timer + DELAY : 0;
+    big_timer = fabs(error) < big_error ? big_timer + DELAY : 0;
+    velocity_timer = fabs(error - last_error) < 0.01 ? velocity_timer + DELAY : 0;
+    last_error = error;
+    if (small_timer >= small_time || big_timer >= big_time) return 1;
+    if (velocity_timer >= velocity_time) return 2;
+    return 0;
+  }
+};
+
+class drive {
+ public:
+  bool interfered = false;
+
+  // Constants, same calls as EZ-Template
+  void pid_heading_constants_set(double p, double i, double d) { heading_pid.constants_set(p, i, d); }
+  void pid_drive_constants_set(double p, double i, double d) {
+    left_pid.constants_set(p, i, d);
+    right_pid.constants_set(p, i, d);
+    odom_pid.constants_set(p, i, d);
+  }
+  void pid_turn_constants_set(double p, double i, double d, double start_i = 0) { turn_pid.constants_set(p, i, d, start_i); }
+  void pid_swing_constants_set(double p, double i, double d, double start_i = 0) { swing_pid.constants_set(p, i, d, start_i); }
+  void pid_drive_exit_condition_set(okapi::QTime st, okapi::QLength se, okapi::QTime bt, okapi::QLength be, okapi::QTime vt, okapi::QTime) {
+    drive_exit.set(st.ms, se.in, bt.ms, be.in, vt.ms);
+  }
+  void pid_turn_exit_condition_set(okapi::QTime st, okapi::QAngle se, okapi::QTime bt, okapi::QAngle be, okapi::QTime vt, okapi::QTime) {
+    turn_exit.set(st.ms, se.deg, bt.ms, be.deg, vt.ms);
+  }
+  void pid_swing_exit_condition_set(okapi::QTime st, okapi::QAngle se, okapi::QTime bt, okapi::QAngle be, okapi::QTime vt, okapi::QTime) {
+    swing_exit.set(st.ms, se.deg, bt.ms, be.deg, vt.ms);
+  }
+  void pid_drive_chain_constant_set(okapi::QLength l) { drive_chain = l.in; }
+  void pid_turn_chain_constant_set(okapi::QAngle a) { turn_chain = a.deg; }
+  void pid_swing_chain_constant_set(okapi::QAngle a) { swing_chain = a.deg; }
+  void slew_drive_constants_set(okapi::QLength distance, int min_speed) {
+    slew_distance = distance.in;
+    slew_min = min_speed;
+  }
+
+  // Motions
+  void pid_drive_set(okapi::QLength target, int speed, bool slew_on = false, bool = true) { pid_drive_set(target.in, speed, slew_on); }
+  void pid_drive_set(double target, int speed, bool slew_on = false, bool = true) {
+    step s = {STEP_DRIVE};
+    s.target = target;
+    s.speed = speed;
+    s.slew = slew_on;
+    record(s);
+    mode = DRIVE;
+    left_pid.reset(sensed_left + target, sensed_left);
+    right_pid.reset(sensed_right + target, sensed_right);
+    heading_pid.reset(heading_target, sensed_imu);
+    start(speed, slew_on);
+  }
+  void pid_turn_set(okapi::QAngle target, int speed, bool slew_on = false) { pid_turn_set(target.deg, speed, slew_on); }
+  void pid_turn_set(double target, int speed, bool slew_on = false) {
+    step s = {STEP_TURN};
+    s.target = target;
+    s.speed = speed;
+    s.slew = slew_on;
+    record(s);
+    mode = TURN;
+    heading_target = target;
+    turn_pid.reset(target, sensed_imu);
+    start(speed, slew_on);
+  }
+  void pid_turn_relative_set(okapi::QAngle target, int speed, bool slew_on = false) { pid_turn_relative_set(target.deg, speed, slew_on); }
+  void pid_turn_relative_set(double target, int speed, bool slew_on = false) { pid_turn_set(heading_target + target, speed, slew_on); }
+  void pid_swing_set(ez::e_swing type, okapi::QAngle target, int speed, int opposite_speed = 0, bool slew_on = false) {
+    pid_swing_set(type, target.deg, speed, opposite_speed, slew_on);
+  }
+  void pid_swing_set(ez::e_swing type, double target, int speed, int opposite_speed = 0, bool slew_on = false) {
+    step s = {STEP_SWING};
+    s.target = target;
+    s.speed = speed;
+    s.opposite = opposite_speed;
+    s.side = type;
+    s.slew = slew_on;
+    record(s);
+    mode = type == ez::LEFT_SWING ? LEFT_SWING : RIGHT_SWING;
+    heading_target = target;
+    swing_pid.reset(target, sensed_imu);
+    swing_opposite = opposite_speed;
+    start(speed, slew_on);
+  }
+  // Boomerang to a pose, EZ-Template's pid_odom_set() with an angle
+  void pid_odom_set(ez::odom movement, bool slew_on = false) {
+    step s = {STEP_ODOM};
+    s.to = {movement.target.x, movement.target.y, movement.target.theta};
+    s.reverse = movement.drive_direction == ez::REV;
+    s.speed = movement.max_xy_speed;
+    s.slew = slew_on;
+    record(s);
+    mode = ODOM;
+    odom_target = s.to;
+    odom_reverse = s.reverse;
+    heading_target = s.to.theta;
+    odom_pid.reset(0, 0);
+    heading_pid.reset(0, 0);
+    start(s.speed, slew_on);
+  }
+  void odom_xyt_set(okapi::QLength x, okapi::QLength y, okapi::QAngle theta) {
+    odom_x = x.in;
+    odom_y = y.in;
+    odom_theta = theta.deg;
+  }
+  void pid_speed_max_set(int speed) {
+    step s = {STEP_SPEED_MAX};
+    s.speed = speed;
+    record(s);
+    max_speed = abs(speed);
+  }
+
+  void pid_wait() { wait(WAIT_SETTLE); }
+  void pid_wait_quick_chain() { wait(WAIT_CHAIN); }
+  void pid_wait_until(okapi::QLength target) { pid_wait_until(target.in); }
+  void pid_wait_until(double target) {
+    step s = {STEP_WAIT_UNTIL};
+    s.target = target;
+    record(s);
+    // Until the robot has driven past target, in the direction of the motion
+    auto traveled = [&]() { return (sensed_left - start_left + sensed_right - start_right) / 2.0; };
+    while (target >= 0 ? traveled() < target : traveled() > target) motion_tick();
+  }
+  void drive_sensor_reset() {
+    encoder_left = encoder_right = 0;
+    imu_zero = true_theta - start_theta;
+    sense();
+  }
+
+  // Simulation
+  void reset(const robot_t& r, uint64_t seed, double limit_ms) {
+    robot = r;
+    random.seed(seed);
+    true_x = r.x;
+    true_y = r.y;
+    true_theta = start_theta = r.theta;
+    imu_zero = 0;
+    velocity_left = velocity_right = encoder_left = encoder_right = 0;
+    time = 0;
+    limit = limit_ms;
+    heading_target = 0;
+    mode = NONE;
+    interfered = cut_off = false;
+    stalls = 0;
+    last_action = 0;
+    events.clear();
+    recording = nullptr;
+    sensed_left = sensed_right = sensed_imu = 0;
+    sense();
+    odom_x = odom_y = odom_theta = 0;
+  }
+
+  // Runs the drive for ms, pros::delay()
+  void delay(double ms) {
+    step s = {STEP_DELAY};
+    s.target = ms;
+    record(s);
+    for (double t = 0; t < ms; t += DELAY) tick();
+  }
+
+  // Marks the end of a command, for the completion time, and remembers where mechanisms were used.
+  //  A mechanism call that blocks runs the drive for its dwell in ms
+  void action(const std::string& code = "", double dwell = 0) {
+    last_action = time;
+    if (code == "") return;
+    events.push_back(pose_get());
+    step s = {STEP_MECHANISM};
+    s.target = dwell;
+    s.code = code;
+    record(s);
+    for (double t = 0; t < dwell; t += DELAY) tick();
+    if (dwell > 0) last_action = time;
+  }
+
+  pose pose_get() const { return {true_x, true_y, true_theta}; }
+
+  double time = 0;         // ms since the auton started
+  double last_action = 0;  // ms, when the last motion settled or a mechanism was used
+  bool cut_off = false;    // true if time ran out partway through a motion
+  int stalls = 0;          // motions that gave up because the robot stopped moving
+  std::vector<pose> events;
+  std::vector<step>* recording = nullptr;  // every command is added here when set
+
+ private:
+  enum e_mode { NONE, DRIVE, TURN, LEFT_SWING, RIGHT_SWING, ODOM };
+
+  void record(const step& s) {
+    if (recording != nullptr) recording->push_back(s);
+  }
+
+  void start(int speed, bool slew_on) {
+    max_speed = abs(speed);
+    slew = slew_on && max_speed > slew_min;
+    start_left = sensed_left;
+    start_right = sensed_right;
+    drive_exit.reset();
+    turn_exit.reset();
+    swing_exit.reset();
+  }
+
+  void wait(e_wait how) {
+    if (recording != nullptr && !recording->empty() && recording->back().kind <= STEP_ODOM) recording->back().wait = how;
+    bool chain = how == WAIT_CHAIN;
+    while (mode != NONE) {
+      motion_tick();
+      int result = 0;
+      if (mode == DRIVE) {
+        double error = std::max(fabs(left_pid.error), fabs(right_pid.error));
+        result = chain ? (error < drive_chain) : drive_exit.check(error);
+      } else if (mode == ODOM) {
+        result = chain ? (odom_distance < drive_chain) : drive_exit.check(odom_distance);
+      } else if (mode == TURN) {
+        result = chain ? (fabs(turn_pid.error) < turn_chain) : turn_exit.check(turn_pid.error);
+      } else {
+        result = chain ? (fabs(swing_pid.error) < swing_chain) : swing_exit.check(swing_pid.error);
+      }
+      if (result == 2) {
+        stalls++;
+        interfered = true;
+      }
+      if (result != 0) break;
+    }
+    action();
+  }
+
+  void motion_tick() {
+    try {
+      tick();
+    } catch (period_over&) {
+      cut_off = true;
+      throw;
+    }
+  }
+
+  // Reads the sensors once per loop like EZ-Template does, and runs odometry on them
+  void sense() {
+    double left = encoder_left * WHEEL / robot.wheel + robot.encoder_noise * unit(random);
+    double right = encoder_right * WHEEL / robot.wheel + robot.encoder_noise * unit(random);
+    double imu = (true_theta - start_theta - imu_zero) * (1.0 + robot.imu_scale) + robot.imu_drift * time / 1000.0 + robot.imu_noise * unit(random);
+    double forward = (left - sensed_left + right - sensed_right) / 2.0;
+    double mid = (sensed_imu + imu) / 2.0 * M_PI / 180.0;
+    odom_x += forward * sin(mid);
+    odom_y += forward * cos(mid);
+    odom_theta += imu - sensed_imu;
+    sensed_left = left;
+    sensed_right = right;
+    sensed_imu = imu;
+  }
+
+  // One EZ-Template loop and 10ms of physics
+  void tick() {
+    if (time >= limit) throw period_over();
+    double left = 0, right = 0;
+    double speed = max_speed;
+    if (slew && (mode == DRIVE || mode == ODOM)) {
+      double traveled = fabs((sensed_left - start_left + sensed_right - start_right) / 2.0);
+      speed = traveled < slew_distance ? slew_min + (max_speed - slew_min) * traveled / slew_distance : max_speed;
+    }
+    if (mode == DRIVE) {
+      double l = std::clamp(left_pid.compute(sensed_left), -speed, speed);
+      double r = std::clamp(right_pid.compute(sensed_right), -speed, speed);
+      double h = heading_pid.compute(sensed_imu);
+      left = l + h;
+      right = r - h;
+    } else if (mode == ODOM) {
+      // Aim at a carrot point behind the target along its heading, so the robot arrives facing it
+      double direction = odom_reverse ? -1.0 : 1.0;
+      double tx = odom_target.x, ty = odom_target.y, t = odom_target.theta * M_PI / 180.0;
+      odom_distance = hypot(tx - odom_x, ty - odom_y);
+      double cx = tx - direction * BOOMERANG_LEAD * odom_distance * sin(t);
+      double cy = ty - direction * BOOMERANG_LEAD * odom_distance * cos(t);
+      double aim = odom_distance < BOOMERANG_SETTLE ? odom_target.theta : atan2(cx - odom_x, cy - odom_y) * 180.0 / M_PI + (odom_reverse ? 180.0 : 0.0);
+      double heading_error = std::remainder(aim - odom_theta, 360.0);
+      double along = (tx - odom_x) * sin(odom_theta * M_PI / 180.0) + (ty - odom_y) * cos(odom_theta * M_PI / 180.0);
+      double linear = std::clamp(odom_pid.compute_error(along), -speed, speed) * std::max(0.0, cos(heading_error * M_PI / 180.0));
+      double angular = heading_pid.compute_error(heading_error);
+      left = linear + angular;
+      right = linear - angular;
+      double biggest = std::max(fabs(left), fabs(right));
+      if (biggest > max_speed) {
+        left *= max_speed / biggest;
+        right *= max_speed / biggest;
+      }
+    } else if (mode == TURN) {
+      left = std::clamp(turn_pid.compute(sensed_imu), -speed, speed);
+      right = -left;
+    } else if (mode == LEFT_SWING || mode == RIGHT_SWING) {
+      double out = std::clamp(swing_pid.compute(sensed_imu), -speed, speed);
+      double opposite = out > 0 ? swing_opposite : -swing_opposite;
+      left = mode == LEFT_SWING ? out : -opposite;
+      right = mode == LEFT_SWING ? opposite : -out;
+    }
+    left = std::clamp(left, -127.0, 127.0);
+    right = std::clamp(right, -127.0, 127.0);
+
+    // Each side reaches its commanded speed after a lag, the real wheels set how far that goes
+    double top = M_PI * robot.wheel * RPM / 60.0;
+    velocity_left += (left / 127.0 * top * robot.strength_left - velocity_left) * std::min(1.0, DT / robot.lag);
+    velocity_right += (right / 127.0 * top * robot.strength_right - velocity_right) * std::min(1.0, DT / robot.lag);
+    double forward = (velocity_left + velocity_right) / 2.0 * DT;
+    double turn = (velocity_left - velocity_right) / TRACK * DT * 180.0 / M_PI;
+    double mid = (true_theta + turn / 2.0) * M_PI / 180.0;
+    true_x += forward * sin(mid);
+    true_y += forward * cos(mid);
+    true_theta += turn;
+    encoder_left += velocity_left * DT;  // Real inches, sense() scales them by the wheel the program thinks it has
+    encoder_right += velocity_right * DT;
+    time += DELAY;
+    sense();
+  }
+
+  robot_t robot;
+  std::mt19937_64 random;
+  std::normal_distribution<double> unit;
+
+  pid left_pid, right_pid, heading_pid, turn_pid, swing_pid, odom_pid;
+  exit_condition drive_exit, turn_exit, swing_exit;
+  double drive_chain = 3, turn_chain = 3, swing_chain = 5;
+  double slew_distance = 7, slew_min = 80;
+  e_mode mode = NONE;
+  double max_speed = 127, heading_target = 0, start_left = 0, start_right = 0;
+  int swing_opposite = 0;
+  bool slew = false;
+  pose odom_target = {0, 0, 0};
+  bool odom_reverse = false;
+  double odom_distance = 0;
+  double limit = 15000;
+  double true_x = 0, true_y = 0, true_theta = 0, start_theta = 0, imu_zero = 0;
+  double velocity_left = 0, velocity_right = 0, encoder_left = 0, encoder_right = 0;
+  double sensed_left = 0, sensed_right = 0, sensed_imu = 0;
+  double odom_x = 0, odom_y = 0, odom_theta = 0;
+};
+
+// Mechanisms only matter for where the robot is when they're used
+class motor {
+ public:
+  explicit motor(const char* name) : name(name) {}
+  void move(int v) { used("move(" + std::to_string(v) + ")"); }
+  void move_velocity(int v) { used("move_velocity(" + std::to_string(v) + ")"); }
+  void move_relative(double position, int v) {
+    char text[64];
+    snprintf(text, sizeof(text), "move_relative(%g, %i)", position, v);
+    used(text);
+  }
+  void brake() { used("brake()"); }
+
+ private:
+  void used(const std::string& call);
+  const char* name;
+};
+}  // namespace sim
+
+extern thread_local sim::drive chassis;
+extern thread_local sim::motor ladybrown;
+extern thread_local sim::motor inveyor;
+
+inline void sim::motor::used(const std::string& call) { chassis.action(std::string(name) + "." + call); }
+
+inline void set_clamp(int state) { chassis.action("set_clamp(" + std::to_string(state) + ")"); }
+
+// The clamp job's next tick, at worst a whole one, then the dwell
+inline void set_clamp_wait(int state, int ms = 100) {
+  chassis.action("set_clamp_wait(" + std::to_string(state) + (ms == 100 ? "" : ", " + std::to_string(ms)) + ")", sim::DELAY + ms);
+}
+
+namespace pros {
+inline void delay(uint32_t ms) { chassis.delay(ms); }
+}  // namespace pros
+
+namespace motion {
+inline void velocity_constants_set(double, double, double) {}
+}  // namespace motion
@@ -0,0 +1,105 @@
+// Decodes the robot's telemetry stream (see include/telemetry.hpp) into CSV
+//
+//  Build on your computer, this isn't part of the robot program:
+//    g++ -std=c++17 -O2 -I../include telemetry_decode.cpp -o telemetry_decode
+//
+//  Usage:
+//    telemetry_decode /dev/ttyUSB0 [baud]   read a serial adapter, baud defaults to 115200
+//    telemetry_decode capture.bin           read a saved capture
+//    telemetry_decode -                     read stdin
+//
+//  A new header row is printed every time the robot's channel list changes.
+//  Decode counters are printed to stderr on exit.
+//  telemetry_pty_test.cpp checks the encoder and this decoder against a damaged stream.
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "telemetry_codec.hpp"
+
+namespace {
+volatile sig_atomic_t running = 1;
+
+speed_t baud_of(int baud) {
+  switch (baud) {
+    case 9600: return B9600;
+    case 19200: return B19200;
+    case 38400: return B38400;
+    case 57600: return B57600;
+    case 230400: return B230400;
+    case 460800: return B460800;
+    case 921600: return B921600;
+    default: return B115200;
+  }
+}
+
+// Raw mode so the terminal driver doesn't eat 0x00 delimiters or translate line endings
+bool tty_configure(int fd, int baud) {
+  termios tty;
+  if (tcgetattr(fd, &tty) != 0) return false;
+  cfmakeraw(&tty);
+  cfsetispeed(&tty, baud_of(baud));
+  cfsetospeed(&tty, baud_of(baud));
+  tty.c_cc[VMIN] = 1;
+  tty.c_cc[VTIME] = 0;
+  return tcsetattr(fd, TCSANOW, &tty) == 0;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <device|file|-> [baud]\n", argv[0]);
+    return 2;
+  }
+
+  int fd = strcmp(argv[1], "-") == 0 ? STDIN_FILENO : open(argv[1], O_RDONLY | O_NOCTTY);
+  if (fd < 0) {
+    perror(argv[1]);
+    return 1;
+  }
+  if (isatty(fd) && !tty_configure(fd, argc > 2 ? atoi(argv[2]) : 115200)) {
+    perror("tcsetattr");
+    return 1;
+  }
+  signal(SIGINT, [](int) { running = 0; });
+
+  telemetry::decoder decoder;
+  uint32_t header_version = 0;
+  auto on_sample = [&](uint32_t time_ms, uint32_t mask, const double* values) {
+    if (header_version != decoder.schema_version) {
+      header_version = decoder.schema_version;
+      printf("time_ms");
+      for (auto& channel : decoder.channels) {
+        if (channel.defined) printf(",%s", channel.name);
+      }
+      printf("\n");
+    }
+    printf("%u", time_ms);
+    for (int id = 0; id < telemetry::CHANNELS_MAX; id++) {
+      if (!decoder.channels[id].defined) continue;
+      if (mask & (1u << id))
+        printf(",%g", values[id]);
+      else
+        printf(",");
+    }
+    printf("\n");
+    fflush(stdout);
+  };
+
+  uint8_t buffer[512];
+  while (running) {
+    ssize_t length = read(fd, buffer, sizeof(buffer));
+    if (length <= 0) break;
+    decoder.feed(buffer, (size_t)length, on_sample);
+  }
+
+  fprintf(stderr, "frames %u, bad %u, gaps %u, unsynced %u\n", decoder.stats.frames, decoder.stats.bad_frames,
+          decoder.stats.gaps, decoder.stats.unsynced);
+  if (fd != STDIN_FILENO) close(fd);
+  return 0;
+}
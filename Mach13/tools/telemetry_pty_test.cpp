@@ -0,0 +1,220 @@
+// Checks the telemetry codec (see include/telemetry_codec.hpp) end to end over a pseudo terminal
+//
+//  Build on your computer, this isn't part of the robot program:
+//    g++ -std=c++17 -O1 -g -fsanitize=address,undefined -I../include telemetry_pty_test.cpp -o telemetry_pty_test
+//
+//  Usage:
+//    telemetry_pty_test [seed]
+//
+//  The encoder writes into one end of a pty pair set up like the serial adapter (raw mode) and the
+//  decoder reads the other end, the same path telemetry_decode takes.  Each scenario damages the
+//  stream a different way: garbage between frames, frames cut short, and runs longer than any frame.
+//  A scenario passes if every sample the decoder hands out has the values that were sent, and enough
+//  of them get through.  Exits 1 if any scenario fails.
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "telemetry_codec.hpp"
+
+namespace {
+const int SAMPLES = 400;
+const uint32_t PERIOD_MS = 10;
+const int CHANNELS = 6;
+const float SCALES[CHANNELS] = {0.01f, 0.01f, 0.01f, 0.1f, 1.0f, 0.001f};
+
+typedef struct pty_pair {
+  int writer = -1;  // master, the robot's end
+  int reader = -1;  // slave, the computer's end
+} pty_pair;
+
+typedef struct result {
+  int samples = 0;  // handed out by the decoder
+  int wrong = 0;    // with a value that wasn't sent
+  telemetry::decoder::stats_t stats;
+} result;
+
+// What the robot sends for a channel at a time
+double truth(int id, uint32_t time_ms) {
+  double t = time_ms / 1000.0;
+  switch (id) {
+    case 0: return 48.0 * sin(t * 0.7);
+    case 1: return -30.0 + 20.0 * cos(t * 1.3);
+    case 2: return fmod(t * 90.0, 360.0);
+    case 3: return 100.0 * sin(t * 5.0);
+    case 4: return round(600.0 * sin(t * 2.0));
+    default: return 12.5 + 0.2 * sin(t * 9.0);
+  }
+}
+
+bool pty_open(pty_pair& pty) {
+  pty.writer = posix_openpt(O_RDWR | O_NOCTTY);
+  if (pty.writer < 0 || grantpt(pty.writer) != 0 || unlockpt(pty.writer) != 0) return false;
+  pty.reader = open(ptsname(pty.writer), O_RDWR | O_NOCTTY);
+  if (pty.reader < 0) return false;
+
+  // Raw on both ends, like tty_configure() in telemetry_decode, so 0x00 and \r\n pass through untouched
+  for (int fd : {pty.writer, pty.reader}) {
+    termios tty;
+    if (tcgetattr(fd, &tty) != 0) return false;
+    cfmakeraw(&tty);
+    if (tcsetattr(fd, TCSANOW, &tty) != 0) return false;
+  }
+  return true;
+}
+
+void pty_close(pty_pair& pty) {
+  if (pty.reader >= 0) close(pty.reader);
+  if (pty.writer >= 0) close(pty.writer);
+}
+
+// Feeds whatever the reader end has, waiting up to wait_ms for the first byte
+template <typename F>
+void drain(const pty_pair& pty, telemetry::decoder& decoder, int wait_ms, F&& on_sample) {
+  uint8_t buffer[512];
+  pollfd p = {pty.reader, POLLIN, 0};
+  while (poll(&p, 1, wait_ms) > 0) {
+    ssize_t length = read(pty.reader, buffer, sizeof(buffer));
+    if (length <= 0) break;
+    decoder.feed(buffer, (size_t)length, on_sample);
+    wait_ms = 0;
+  }
+}
+
+bool send(const pty_pair& pty, const uint8_t* data, size_t length) {
+  while (length > 0) {
+    ssize_t written = write(pty.writer, data, length);
+    if (written <= 0) return false;
+    data += written;
+    length -= written;
+  }
+  return true;
+}
+
+// Streams SAMPLES samples, letting damage() add to or cut each one's bytes before they're written
+result run(std::function<void(int, std::vector<uint8_t>&)> damage) {
+  result r;
+  pty_pair pty;
+  if (!pty_open(pty)) {
+    perror("pty");
+    pty_close(pty);
+    r.wrong = -1;
+    return r;
+  }
+
+  telemetry::encoder encoder;
+  static const char* names[CHANNELS] = {"x", "y", "theta", "turn_error", "left_vel", "battery"};
+  for (int id = 0; id < CHANNELS; id++) encoder.channel_set(id, names[id], SCALES[id]);
+  encoder.subscribe((1u << CHANNELS) - 1);
+
+  telemetry::decoder decoder;
+  auto on_sample = [&](uint32_t time_ms, uint32_t mask, const double* values) {
+    r.samples++;
+    for (int id = 0; id < CHANNELS; id++) {
+      if (!(mask & (1u << id))) continue;
+      if (fabs(values[id] - truth(id, time_ms)) > SCALES[id] * 0.5 + 1e-6) {
+        r.wrong++;
+        return;
+      }
+    }
+  };
+
+  uint8_t out[2 * telemetry::ENCODED_MAX];
+  double values[telemetry::CHANNELS_MAX] = {};
+  for (int n = 0; n < SAMPLES; n++) {
+    uint32_t time_ms = 1000 + n * PERIOD_MS;
+    for (int id = 0; id < CHANNELS; id++) values[id] = truth(id, time_ms);
+    size_t length = encoder.encode(time_ms, values, out);
+    if (length == 0) continue;
+    encoder.commit();
+
+    std::vector<uint8_t> bytes(out, out + length);
+    damage(n, bytes);
+    if (!send(pty, bytes.data(), bytes.size())) break;
+    drain(pty, decoder, 0, on_sample);
+  }
+  drain(pty, decoder, 50, on_sample);
+
+  r.stats = decoder.stats;
+  pty_close(pty);
+  return r;
+}
+
+bool report(const char* name, const result& r, int min_samples) {
+  bool pass = r.wrong == 0 && r.samples >= min_samples;
+  printf("%-12s %s  samples %3d/%d (need %d), wrong %d, frames %u, bad %u, gaps %u, unsynced %u\n", name, pass ? "pass" : "FAIL",
+         r.samples, SAMPLES, min_samples, r.wrong, r.stats.frames, r.stats.bad_frames, r.stats.gaps, r.stats.unsynced);
+  return pass;
+}
+
+// A schema that would outgrow FRAME_MAX is refused instead of silently not being sent
+bool schema_limit() {
+  telemetry::encoder encoder;
+  int accepted = 0;
+  for (int id = 0; id < telemetry::CHANNELS_MAX; id++) {
+    char name[32];
+    snprintf(name, sizeof(name), "long_channel_%02d", id);
+    accepted += encoder.channel_set(id, name, 0.01f);
+  }
+  encoder.subscribe(0xFFFFFFFFu);
+  uint8_t out[2 * telemetry::ENCODED_MAX];
+  double values[telemetry::CHANNELS_MAX] = {};
+  size_t length = encoder.encode(0, values, out);
+  bool pass = accepted > 0 && accepted < telemetry::CHANNELS_MAX && length > 0;
+  printf("%-12s %s  %d of %d long channels accepted, first frames %zu bytes\n", "schema", pass ? "pass" : "FAIL", accepted,
+         telemetry::CHANNELS_MAX, length);
+  return pass;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::mt19937 random(argc > 1 ? atoi(argv[1]) : 1);
+  auto chance = [&](double p) { return std::uniform_real_distribution<double>(0.0, 1.0)(random) < p; };
+  bool pass = true;
+
+  pass &= report("clean", run([](int, std::vector<uint8_t>&) {}), SAMPLES);
+
+  // Damage hits every 50th frame.  Each hit costs at most the frames up to the next keyframe or two,
+  // since deltas are ignored until then, so at least a third of the samples have to get through
+
+  // Line noise between frames, sometimes ending in its own 0x00 and sometimes running into the next frame
+  pass &= report("garbage", run([&](int n, std::vector<uint8_t>& bytes) {
+                   if (n % 50 != 20) return;
+                   std::vector<uint8_t> noise(1 + random() % 40);
+                   for (auto& b : noise) b = random() % 256;
+                   bytes.insert(bytes.begin(), noise.begin(), noise.end());
+                 }),
+                 SAMPLES / 3);
+
+  // Frames cut short, the way a reader that drops bytes sees them
+  pass &= report("truncated", run([&](int n, std::vector<uint8_t>& bytes) {
+                   if (n % 50 != 40) return;
+                   bytes.resize(1 + random() % (bytes.size() - 1));
+                   if (chance(0.5)) bytes.push_back(0x00);
+                 }),
+                 SAMPLES / 3);
+
+  // Runs longer than any frame.  0x01 codes decode to one byte each, so a run of ENCODED_MAX of them
+  // decodes to more than FRAME_MAX bytes
+  pass &= report("oversized", run([&](int n, std::vector<uint8_t>& bytes) {
+                   if (n % 50 != 25) return;
+                   size_t run_length = n % 100 == 25 ? telemetry::ENCODED_MAX : 3 * telemetry::ENCODED_MAX;
+                   std::vector<uint8_t> run_bytes(run_length, n % 100 == 25 ? 0x01 : 0x7E);
+                   run_bytes.push_back(0x00);
+                   bytes.insert(bytes.begin(), run_bytes.begin(), run_bytes.end());
+                 }),
+                 SAMPLES * 3 / 4);
+
+  pass &= schema_limit();
+
+  return pass ? 0 : 1;
+}